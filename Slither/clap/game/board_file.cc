@@ -0,0 +1,139 @@
+#include "clap/game/board_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace clap::game {
+
+BoardFile::BoardFile(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("cannot open " + path);
+  struct stat status;
+  if (::fstat(fd, &status) == 0) length = status.st_size;
+  if (length >= sizeof(Header)) {
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped != MAP_FAILED) data = mapped;
+  }
+  ::close(fd);
+  if (!data) throw std::runtime_error("cannot map " + path);
+
+  const Header& h = header();
+  const uint64_t bytes =
+      words(h.cells) * sizeof(uint64_t) +
+      (h.flags & kSortedIndex ? sizeof(uint32_t) : 0);
+  if (h.magic != kMagic || h.version != 1 || h.cells == 0 ||
+      h.cells > kMaxCells || (length - sizeof(Header)) / bytes < h.count ||
+      length != sizeof(Header) + h.count * bytes) {
+    ::munmap(const_cast<void*>(data), length);
+    throw std::runtime_error(path + " is no board file");
+  }
+  // readers go through all of it, so fetch it ahead
+  ::madvise(const_cast<void*>(data), length, MADV_WILLNEED);
+}
+
+BoardFile::~BoardFile() { ::munmap(const_cast<void*>(data), length); }
+
+const uint64_t* BoardFile::masks() const {
+  return reinterpret_cast<const uint64_t*>(static_cast<const char*>(data) +
+                                           sizeof(Header));
+}
+
+const uint32_t* BoardFile::index() const {
+  if (!(header().flags & kSortedIndex)) return nullptr;
+  return reinterpret_cast<const uint32_t*>(masks() + size() * words());
+}
+
+namespace {
+
+// masks of `words` words as numbers, highest word first
+bool mask_less(const uint64_t* a, const uint64_t* b, uint32_t words) {
+  for (uint32_t w = words; w-- > 0;)
+    if (a[w] != b[w]) return a[w] < b[w];
+  return false;
+}
+
+}  // namespace
+
+int64_t BoardFile::find(const uint64_t* mask) const {
+  const uint32_t n = words();
+  const uint64_t* boards = masks();
+  if (const uint32_t* rows = index()) {
+    const uint32_t* it = std::lower_bound(
+        rows, rows + size(), mask, [&](uint32_t row, const uint64_t* key) {
+          return mask_less(boards + uint64_t{row} * n, key, n);
+        });
+    return it != rows + size() &&
+                   std::equal(mask, mask + n, boards + uint64_t{*it} * n)
+               ? int64_t{*it}
+               : -1;
+  }
+  for (uint64_t row = 0; row < size(); ++row)
+    if (std::equal(mask, mask + n, boards + row * n)) return row;
+  return -1;
+}
+
+int64_t BoardFile::find(uint64_t mask) const {
+  if (words() != 1) throw std::invalid_argument("boards of several words");
+  return find(&mask);
+}
+
+void BoardFile::write(const std::string& path, uint32_t cells,
+                      const std::vector<uint64_t>& masks, bool sorted_index) {
+  if (cells == 0 || cells > kMaxCells)
+    throw std::invalid_argument("cells out of range");
+  const uint32_t n = words(cells);
+  if (masks.size() % n) throw std::invalid_argument("a board cut short");
+  const uint64_t count = masks.size() / n;
+  const uint64_t spare = cells % 64 ? ~uint64_t{0} << cells % 64 : 0;
+  for (uint64_t row = 0; row < count; ++row)
+    if (masks[row * n + n - 1] & spare)
+      throw std::invalid_argument("a board outside the cells");
+  if (sorted_index && count > UINT32_MAX)
+    throw std::invalid_argument("too many boards for an index");
+
+  const Header header{kMagic, 1, cells, sorted_index ? kSortedIndex : 0,
+                      count};
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(masks.data()),
+             masks.size() * sizeof(uint64_t));
+  if (sorted_index) {
+    std::vector<uint32_t> rows(count);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) {
+      return mask_less(&masks[uint64_t{a} * n], &masks[uint64_t{b} * n], n);
+    });
+    file.write(reinterpret_cast<const char*>(rows.data()),
+               rows.size() * sizeof(uint32_t));
+  }
+  if (!file) throw std::runtime_error("cannot write " + path);
+}
+
+std::vector<uint64_t> BoardFile::read_text(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) throw std::runtime_error("cannot open " + path);
+  std::vector<uint64_t> masks;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream cells(line);
+    uint64_t mask = 0;
+    bool empty = true;
+    for (int cell; cells >> cell; empty = false) {
+      if (cell < 0 || cell >= 64)
+        throw std::runtime_error(path + ": cell " + std::to_string(cell));
+      mask |= uint64_t{1} << cell;
+    }
+    if (!empty) masks.push_back(mask);
+  }
+  return masks;
+}
+
+}  // namespace clap::game
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clap::game {
+
+// A read-only file of boards, each a mask of its cells in words() uint64_t
+// words (lowest cells first, one word up to 64 cells), mapped into memory and
+// used in place: winning paths, checkmate databases.
+//
+//   Header
+//   uint64_t masks[count * words]   in the order they were written
+//   uint32_t index[count]           with kSortedIndex, the rows by ascending
+//                                   mask, highest word first
+//
+// all in host byte order; the masks start 8-byte aligned.
+class BoardFile {
+ public:
+  // Header::flags
+  static constexpr uint32_t kSortedIndex = 1;
+  static constexpr uint32_t kMaxCells = 1024;
+
+  explicit BoardFile(const std::string& path);
+  ~BoardFile();
+  BoardFile(const BoardFile&) = delete;
+  BoardFile& operator=(const BoardFile&) = delete;
+
+  static uint32_t words(uint32_t cells) { return (cells + 63) / 64; }
+
+  uint32_t cells() const { return header().cells; }
+  uint32_t words() const { return words(cells()); }
+  uint64_t size() const { return header().count; }
+  // row i at masks() + i * words()
+  const uint64_t* masks() const;
+  // nullptr when the file was written without one
+  const uint32_t* index() const;
+
+  // the row of a board, or -1; a binary search with the index, a scan without
+  int64_t find(const uint64_t* mask) const;
+  // of a file of one word per board
+  int64_t find(uint64_t mask) const;
+
+  // masks holds words(cells) words per board
+  static void write(const std::string& path, uint32_t cells,
+                    const std::vector<uint64_t>& masks, bool sorted_index);
+  // one board per line as ascending cell numbers, the text format of
+  // winning_path/ and checkmate/
+  static std::vector<uint64_t> read_text(const std::string& path);
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cells;
+    uint32_t flags;
+    uint64_t count;
+  };
+  static constexpr uint32_t kMagic = 0x46424c53;  // "SLBF"
+
+  const Header& header() const {
+    return *static_cast<const Header*>(data);
+  }
+
+  const void* data = nullptr;
+  size_t length = 0;
+};
+
+}  // namespace clap::game
@@ -1,6 +1,8 @@
 #include "clap/game/game.h"
 
 #include <algorithm>
+#include <functional>
+#include <numeric>
 #include <sstream>
 
 namespace clap::game {
@@ -22,6 +24,42 @@ std::vector<float> Game::restore_policy(const std::vector<float>& policy,
   return std::vector<float>(policy);
 }
 
+void Game::transform_observations(float* observations, int batch,
+                                  int type) const {
+  if (type == 0) return;
+  const auto shape = observation_tensor_shape();
+  const int size =
+      std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<>());
+  for (int i = 0; i < batch; ++i) {
+    float* begin = observations + i * size;
+    const auto transformed =
+        transform_observation(std::vector<float>(begin, begin + size), type);
+    std::copy(transformed.begin(), transformed.end(), begin);
+  }
+}
+
+void Game::transform_policies(float* policies, int batch, int type) const {
+  if (type == 0) return;
+  const int size = num_distinct_actions();
+  for (int i = 0; i < batch; ++i) {
+    float* begin = policies + i * size;
+    const auto transformed =
+        transform_policy(std::vector<float>(begin, begin + size), type);
+    std::copy(transformed.begin(), transformed.end(), begin);
+  }
+}
+
+void Game::restore_policies(float* policies, int batch, int type) const {
+  if (type == 0) return;
+  const int size = num_distinct_actions();
+  for (int i = 0; i < batch; ++i) {
+    float* begin = policies + i * size;
+    const auto restored =
+        restore_policy(std::vector<float>(begin, begin + size), type);
+    std::copy(restored.begin(), restored.end(), begin);
+  }
+}
+
 Factory& Factory::instance() {
   static Factory impl;
   return impl;
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace clap::game {
@@ -16,6 +19,31 @@ using StatePtr = std::unique_ptr<State>;
 class Game;
 using GamePtr = std::shared_ptr<const Game>;
 
+// What make_action changed, for undo_action to restore. The slots are the
+// game's own.
+struct UndoRecord {
+  std::array<int, 8> data;
+};
+
+// Boards of an enumeration handed out a batch at a time, so it never sits in
+// memory whole. A batch shorter than asked for is the last one.
+class BoardStream {
+ public:
+  virtual ~BoardStream() = default;
+  virtual std::vector<std::vector<int>> next_batch(int size) = 0;
+  // candidates that passed the diagonal rule so far, kept or not
+  virtual int64_t valid() const = 0;
+};
+
+// test_prune on one checkmate board: the white boards of as many stones that
+// pass the diagonal rule, those the critical points leave unblocked, and the
+// first of these black cannot win on in one turn (empty if there is none).
+struct PruneStats {
+  int64_t valid = 0;
+  int64_t kept = 0;
+  std::vector<int> counterexample;
+};
+
 class State {
  public:
   State(GamePtr game) : game_(game) {}
@@ -25,6 +53,13 @@ class State {
   virtual std::vector<Action> legal_actions() const = 0;
   virtual std::vector<float> observation_tensor() const = 0;
   virtual void apply_action(const Action&) = 0;
+  // make/unmake: apply_action that can be taken back by undo_action, in
+  // last-in first-out order, for searches in a single state
+  virtual bool supports_undo() const { return false; }
+  virtual void make_action(const Action& action, UndoRecord&) {
+    apply_action(action);
+  }
+  virtual void undo_action(const UndoRecord&) {}
   virtual void manual_action(const Action&, Player) { return; }
   // 11/7 modified
   // virtual std::vector<std::vector<Action>> return_path() { return {};}
@@ -34,6 +69,10 @@ class State {
   virtual bool test_board(std::vector<Action>) { return 0; }
   virtual int test_generate(std::vector<Action>, int, int) { return 0; }
   virtual bool check_can_block() {return 0;};
+  // exact one-turn tactics of the side to move, at the start of a turn: a
+  // turn that wins, a turn after which the opponent has none
+  virtual bool win_in_one() { return 0; }
+  virtual bool block_in_one() { return 0; }
   virtual uint64_t convert_to_uint64_t(std::vector<int> M) {return 0;}
   // virtual void store_TT(std::unordered_map<uint64_t, int> &, std::vector<int>, int) {return ;};
   // virtual bool lookup_TT(std::unordered_map<uint64_t, int> &, std::vector<int>) {return 0;};
@@ -43,8 +82,16 @@ class State {
   virtual std::vector<std::vector<int>> match_WP() {return {};}
   virtual int DFS_noBlock(std::vector<int> &M, int cnt, int max, int num, std::vector<std::vector<int>>CPs, int&) { return 0; }
   virtual std::vector<std::vector<int>> get_noBlock() {return{};}
+  // DFS_noBlock and generate as streams, without the noBlock / MM lists
+  virtual std::unique_ptr<BoardStream> stream_noBlock(std::vector<int> M, int cnt, std::vector<std::vector<int>> CPs) { return nullptr; }
+  virtual std::unique_ptr<BoardStream> stream_generate(int cnt) { return nullptr; }
+  // PruneStats of each board of black stones given as a mask, on `threads`
+  // threads (0 for one per core); brute_force tries white boards with
+  // test_board rather than the tactical oracle
+  virtual std::vector<PruneStats> prune_analysis(const std::vector<uint64_t>& boards, int threads, bool brute_force) { return {}; }
   virtual std::vector<int> getboard() {return {};}
   virtual std::vector<std::vector<int>> get_critical(std::vector<std::vector<int>>) {return {};}
+  virtual std::vector<std::vector<int>> critical_points() {return {};}
   // 11/7 modified
   //whp
   virtual bool check_diag(std::vector<int>) { return 0; };
@@ -85,6 +132,10 @@ class Game : public std::enable_shared_from_this<Game> {
                                               int) const;
   virtual std::vector<float> restore_policy(const std::vector<float>&,
                                             int) const;
+  // in-place variants over `batch` contiguous observations / policies
+  virtual void transform_observations(float*, int batch, int) const;
+  virtual void transform_policies(float*, int batch, int) const;
+  virtual void restore_policies(float*, int batch, int) const;
 
   virtual std::string action_to_string(const Action& action) const {
     return std::to_string(action);
@@ -98,6 +149,10 @@ class Game : public std::enable_shared_from_this<Game> {
 
   virtual int getBoardSize() const { return 0; }
   virtual bool save_manual(const std::vector<Action>, const std::string) const { return false; }
+  // memoized position analyses shared by all states of the game keep up to
+  // `entries` results, 0 disables them; the first nonzero size holds for the
+  // life of the process
+  virtual void set_cache_entries(size_t entries) const {}
 
 };
 
@@ -113,6 +168,65 @@ class Factory {
   std::unordered_map<std::string, CreateFunc> factory_;
 };
 
+// Applies an action until the end of the scope: in place by make/unmake when
+// the game supports it, on a copy otherwise.
+class ScopedAction {
+ public:
+  ScopedAction(State& state, const Action& action) : parent_(state) {
+    if (state.supports_undo()) {
+      state.make_action(action, undo_);
+    } else {
+      copy_ = state.clone();
+      copy_->apply_action(action);
+    }
+  }
+  ScopedAction(const ScopedAction&) = delete;
+  ScopedAction& operator=(const ScopedAction&) = delete;
+  ~ScopedAction() {
+    if (!copy_) parent_.undo_action(undo_);
+  }
+
+  State& state() { return copy_ ? *copy_ : parent_; }
+
+ private:
+  State& parent_;
+  StatePtr copy_;
+  UndoRecord undo_;
+};
+
+enum class Visit { kDescend, kPrune, kStop };
+
+// Depth-first walk over the lines of play below `state`, at most `depth`
+// plies deep, with the actions appended to `path` on the way. visit(state,
+// path) sees every position, `state` itself first, and may change the
+// position it is given; changes below `state` are dropped when the walk
+// backs out. Returns false if a visit stopped the walk. With a concrete
+// StateT the calls are direct.
+template <class StateT, class Visitor>
+bool depth_first(StateT& state, int depth, std::vector<Action>& path,
+                 Visitor&& visit) {
+  const Visit next = visit(state, std::as_const(path));
+  if (next == Visit::kStop) return false;
+  if (next == Visit::kPrune || depth <= 0) return true;
+  for (const Action action : state.legal_actions()) {
+    path.push_back(action);
+    bool go_on;
+    if (state.supports_undo()) {
+      UndoRecord undo;
+      state.make_action(action, undo);
+      go_on = depth_first(state, depth - 1, path, visit);
+      state.undo_action(undo);
+    } else {
+      StatePtr child = state.clone();
+      child->apply_action(action);
+      go_on = depth_first(static_cast<StateT&>(*child), depth - 1, path, visit);
+    }
+    path.pop_back();
+    if (!go_on) return false;
+  }
+  return true;
+}
+
 template <class GameType>
 struct Registration {
   Registration() {
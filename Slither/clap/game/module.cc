@@ -1,6 +1,12 @@
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+#include "clap/game/board_file.h"
 #include "clap/game/game.h"
 
 namespace clap::game {
@@ -9,9 +15,114 @@ namespace {
 namespace py = ::pybind11;
 using py::literals::operator""_a;
 
+using Array = py::array_t<float, py::array::c_style>;
+
+// boards per batch when a BoardStream is iterated
+constexpr int kStreamBatchSize = 4096;
+
+// apply an in-place batch transformation to a (batch, ...) float32 array
+template <void (Game::*Transform)(float*, int, int) const>
+void transform_batch(const Game& game, Array array, int type, int row_size) {
+  if (array.ndim() < 1 || array.size() != array.shape(0) * row_size) {
+    throw std::invalid_argument("expected an array of shape (batch, " +
+                                std::to_string(row_size) + ")");
+  }
+  float* data = array.mutable_data();
+  const int batch = array.shape(0);
+  py::gil_scoped_release release;
+  (game.*Transform)(data, batch, type);
+}
+
+// a read-only C-ordered view of `shape` values owned by `base`
+template <class T>
+py::array view(const T* data, std::vector<py::ssize_t> shape,
+               py::handle base) {
+  std::vector<py::ssize_t> strides(shape.size(), sizeof(T));
+  for (size_t i = shape.size() - 1; i > 0; --i)
+    strides[i - 1] = strides[i] * shape[i];
+  py::array_t<T> array(shape, strides, data, base);
+  py::detail::array_proxy(array.ptr())->flags &=
+      ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return std::move(array);
+}
+
+int64_t find_words(const BoardFile& file, const std::vector<uint64_t>& mask) {
+  if (mask.size() != file.words())
+    throw std::invalid_argument("expected " + std::to_string(file.words()) +
+                                " words");
+  return file.find(mask.data());
+}
+
+int observation_size(const Game& game) {
+  const auto shape = game.observation_tensor_shape();
+  return std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<>());
+}
+
 PYBIND11_MODULE(game, m) {  // NOLINT
   m.def("list", &list).def("load", &load, "name"_a);
 
+  // iterating yields lists of up to batch_size boards
+  py::class_<BoardStream>(m, "BoardStream")
+      .def("next_batch", &BoardStream::next_batch, "size"_a,
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("valid", &BoardStream::valid)
+      .def("__iter__", [](BoardStream& stream) -> BoardStream& { return stream; })
+      .def("__next__", [](BoardStream& stream) {
+        std::vector<std::vector<int>> batch;
+        {
+          py::gil_scoped_release release;
+          batch = stream.next_batch(kStreamBatchSize);
+        }
+        if (batch.empty()) throw py::stop_iteration();
+        return batch;
+      });
+
+  // masks and index are read-only NumPy views of the mapped file, which
+  // stays mapped while any of them lives; masks is (count, words) for boards
+  // of more than 64 cells
+  py::class_<BoardFile, std::shared_ptr<BoardFile>>(m, "BoardFile")
+      .def(py::init<const std::string&>(), "path"_a)
+      .def_property_readonly("cells", &BoardFile::cells)
+      .def("__len__", &BoardFile::size)
+      .def_property_readonly(
+          "masks",
+          [](py::object self) {
+            const auto& file = self.cast<const BoardFile&>();
+            const auto rows = static_cast<py::ssize_t>(file.size());
+            if (file.words() == 1) return view(file.masks(), {rows}, self);
+            return view(file.masks(), {rows, file.words()}, self);
+          })
+      .def_property_readonly(
+          "index",
+          [](py::object self) -> py::object {
+            const auto& file = self.cast<const BoardFile&>();
+            if (!file.index()) return py::none();
+            return view(file.index(),
+                        {static_cast<py::ssize_t>(file.size())}, self);
+          })
+      .def_property_readonly("words",
+                             py::overload_cast<>(&BoardFile::words, py::const_))
+      // a mask of one word, or the words() words of a larger board
+      .def("find", py::overload_cast<uint64_t>(&BoardFile::find, py::const_),
+           "mask"_a)
+      .def("find", &find_words, "mask"_a)
+      .def("__contains__",
+           [](const BoardFile& file, uint64_t mask) {
+             return file.find(mask) >= 0;
+           })
+      .def("__contains__",
+           [](const BoardFile& file, const std::vector<uint64_t>& mask) {
+             return find_words(file, mask) >= 0;
+           })
+      .def_static("write", &BoardFile::write, "path"_a, "cells"_a, "masks"_a,
+                  "sorted_index"_a = true)
+      .def_static("read_text", &BoardFile::read_text, "path"_a);
+
+  py::class_<PruneStats>(m, "PruneStats")
+      .def_readonly("valid", &PruneStats::valid)
+      .def_readonly("kept", &PruneStats::kept)
+      .def_readonly("counterexample", &PruneStats::counterexample);
+
   py::class_<State>(m, "State")
       .def_property_readonly("game", &State::game)
       .def("current_player", &State::current_player)
@@ -31,12 +142,21 @@ PYBIND11_MODULE(game, m) {  // NOLINT
       .def("generate", &State::generate)
       .def("test_generate", &State::test_generate)
       .def("check_can_block", &State::check_can_block)
+      .def("win_in_one", &State::win_in_one)
+      .def("block_in_one", &State::block_in_one)
       // .def("generate_WP", &State::generate_WP)
       .def("match_WP", &State::match_WP)
       .def("DFS_noBlock", &State::DFS_noBlock)
       .def("get_noBlock", &State::get_noBlock)
+      .def("stream_noBlock", &State::stream_noBlock, "M"_a, "cnt"_a, "CPs"_a)
+      .def("stream_generate", &State::stream_generate, "cnt"_a)
+      // boards as black stone masks, e.g. BoardFile.masks
+      .def("prune_analysis", &State::prune_analysis, "boards"_a,
+           "threads"_a = 0, "brute_force"_a = false,
+           py::call_guard<py::gil_scoped_release>())
       .def("getboard", &State::getboard)
       .def("get_critical", &State::get_critical)
+      .def("critical_points", &State::critical_points)
     //whp
       .def("is_terminal", &State::is_terminal)
       .def("get_winner", &State::get_winner)
@@ -60,10 +180,32 @@ PYBIND11_MODULE(game, m) {  // NOLINT
       .def("transform_observation", &Game::transform_observation)
       .def("transform_policy", &Game::transform_policy)
       .def("restore_policy", &Game::restore_policy)
+      .def(
+          "transform_observations",
+          [](const Game& game, Array observations, int type) {
+            transform_batch<&Game::transform_observations>(
+                game, observations, type, observation_size(game));
+          },
+          py::arg("observations").noconvert(), "type"_a)
+      .def(
+          "transform_policies",
+          [](const Game& game, Array policies, int type) {
+            transform_batch<&Game::transform_policies>(
+                game, policies, type, game.num_distinct_actions());
+          },
+          py::arg("policies").noconvert(), "type"_a)
+      .def(
+          "restore_policies",
+          [](const Game& game, Array policies, int type) {
+            transform_batch<&Game::restore_policies>(
+                game, policies, type, game.num_distinct_actions());
+          },
+          py::arg("policies").noconvert(), "type"_a)
       .def("action_to_string", &Game::action_to_string)
       .def("string_to_action", &Game::string_to_action)
       .def_property_readonly("getBoardSize", &Game::getBoardSize)
       .def("save_manual", &Game::save_manual)
+      .def("set_cache_entries", &Game::set_cache_entries, "entries"_a)
       .def("deserialize_state", &Game::deserialize_state);
 }
 
@@ -0,0 +1,116 @@
+#include "clap/game/slither/batch_rules.h"
+
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace clap::game::slither {
+namespace {
+
+// runs `scalar` on every board, `vector` eight at a time where AVX2 allows;
+// `vector` returns all ones in the lanes whose board passes
+template <class Scalar, class Vector>
+void evaluate(const uint32_t* boards, int n, uint64_t* out, Scalar scalar,
+              [[maybe_unused]] Vector vector) {
+  std::fill(out, out + (n + 63) / 64, 0);
+  int i = 0;
+#ifdef __AVX2__
+  for (; i + 8 <= n; i += 8) {
+    const __m256i stones =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boards + i));
+    const uint64_t bits =
+        _mm256_movemask_ps(_mm256_castsi256_ps(vector(stones)));
+    out[i / 64] |= bits << (i % 64);
+  }
+#endif
+  for (; i < n; ++i) out[i / 64] |= uint64_t{scalar(boards[i])} << (i % 64);
+}
+
+#ifdef __AVX2__
+inline __m256i all(uint32_t bits) {
+  return _mm256_set1_epi32(static_cast<int>(bits));
+}
+#endif
+
+}  // namespace
+
+std::vector<uint32_t> BatchRules::masks(
+    const std::vector<std::vector<int>>& sets) {
+  std::vector<uint32_t> masks;
+  masks.reserve(sets.size());
+  for (const auto& set : sets) {
+    uint32_t mask = 0;
+    for (const int cell : set) mask |= uint32_t{1} << cell;
+    masks.push_back(mask);
+  }
+  return masks;
+}
+
+void BatchRules::diag(const uint32_t* boards, int n, uint64_t* out) {
+  evaluate(
+      boards, n, out, [](uint32_t stones) { return diag(stones); },
+#ifdef __AVX2__
+      [](__m256i stones) {
+        const __m256i below = _mm256_srli_epi32(stones, kBoardSize);
+        const __m256i down_left = _mm256_andnot_si256(
+            _mm256_or_si256(below, _mm256_slli_epi32(stones, 1)),
+            _mm256_and_si256(
+                _mm256_and_si256(stones, all(kNotLeft)),
+                _mm256_srli_epi32(stones, kBoardSize - 1)));
+        const __m256i down_right = _mm256_andnot_si256(
+            _mm256_or_si256(below, _mm256_srli_epi32(stones, 1)),
+            _mm256_and_si256(
+                _mm256_and_si256(stones, all(kNotRight)),
+                _mm256_srli_epi32(stones, kBoardSize + 1)));
+        return _mm256_cmpeq_epi32(_mm256_or_si256(down_left, down_right),
+                                  _mm256_setzero_si256());
+      }
+#else
+      nullptr
+#endif
+  );
+}
+
+void BatchRules::win(const uint32_t* boards, int n, uint64_t* out) {
+  evaluate(
+      boards, n, out, [](uint32_t stones) { return win(stones); },
+#ifdef __AVX2__
+      [](__m256i stones) {
+        __m256i column = stones;
+        for (int row = 1; row < kBoardSize; ++row)
+          column = _mm256_and_si256(
+              column, _mm256_srl_epi32(stones,
+                                       _mm_cvtsi32_si128(row * kBoardSize)));
+        column = _mm256_and_si256(column, all(kTopRow));
+        return _mm256_xor_si256(
+            _mm256_cmpeq_epi32(column, _mm256_setzero_si256()),
+            _mm256_set1_epi32(-1));
+      }
+#else
+      nullptr
+#endif
+  );
+}
+
+void BatchRules::blocked(const uint32_t* boards, int n,
+                         const std::vector<uint32_t>& sets, uint64_t* out) {
+  evaluate(
+      boards, n, out,
+      [&sets](uint32_t white) { return blocked(white, sets); },
+#ifdef __AVX2__
+      [&sets](__m256i white) {
+        __m256i covered = _mm256_setzero_si256();
+        for (const uint32_t set : sets)
+          covered = _mm256_or_si256(
+              covered,
+              _mm256_cmpeq_epi32(_mm256_and_si256(white, all(set)), all(set)));
+        return covered;
+      }
+#else
+      nullptr
+#endif
+  );
+}
+
+}  // namespace clap::game::slither
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+
+// check_diag, check_win and check_blocked on the stones of one colour as a
+// 25-bit mask, which is all of a board they read, for one board or a batch.
+// A batch result holds board i in bit i % 64 of word i / 64; with AVX2 every
+// step goes through eight boards at once.
+class BatchRules {
+ public:
+  // boards the enumerators evaluate at a time
+  static constexpr int kBatch = 256;
+  static constexpr int kWords = kBatch / 64;
+
+  static uint32_t mask(const std::vector<int>& M, int color) {
+    uint32_t stones = 0;
+    for (int i = 0; i < kNumOfGrids; ++i)
+      if (M[i] == color) stones |= uint32_t{1} << i;
+    return stones;
+  }
+  static std::vector<uint32_t> masks(const std::vector<std::vector<int>>& sets);
+
+  // check_diag: no two diagonal neighbours without a shared orthogonal one
+  static bool diag(uint32_t stones) {
+    const uint32_t below = stones >> kBoardSize;
+    const uint32_t down_left = stones & kNotLeft & (stones >> (kBoardSize - 1)) &
+                               ~below & ~(stones << 1);
+    const uint32_t down_right = stones & kNotRight &
+                                (stones >> (kBoardSize + 1)) & ~below &
+                                ~(stones >> 1);
+    return !(down_left | down_right);
+  }
+  // check_win, which follows each column straight down: a full column
+  static bool win(uint32_t stones) {
+    uint32_t column = stones;
+    for (int row = 1; row < kBoardSize; ++row)
+      column &= stones >> (row * kBoardSize);
+    return column & kTopRow;
+  }
+  // check_blocked: white covers one of the sets
+  static bool blocked(uint32_t white, const std::vector<uint32_t>& sets) {
+    for (const uint32_t set : sets)
+      if ((white & set) == set) return true;
+    return false;
+  }
+
+  // n <= kBatch boards into out[(n + 63) / 64]
+  static void diag(const uint32_t* boards, int n, uint64_t* out);
+  static void win(const uint32_t* boards, int n, uint64_t* out);
+  static void blocked(const uint32_t* boards, int n,
+                      const std::vector<uint32_t>& sets, uint64_t* out);
+
+ private:
+  static constexpr uint32_t kTopRow = (1u << kBoardSize) - 1;
+  // cells with a row below them, outside the left / right column
+  static constexpr uint32_t kUpperRows = (1u << (kNumOfGrids - kBoardSize)) - 1;
+  static constexpr uint32_t kLeftColumn = [] {
+    uint32_t column = 0;
+    for (int row = 0; row < kBoardSize; ++row)
+      column |= 1u << (row * kBoardSize);
+    return column;
+  }();
+  static constexpr uint32_t kNotLeft = kUpperRows & ~kLeftColumn;
+  static constexpr uint32_t kNotRight =
+      kUpperRows & ~(kLeftColumn << (kBoardSize - 1));
+};
+
+}  // namespace clap::game::slither
@@ -0,0 +1,238 @@
+#include "clap/game/slither/checkmate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include "clap/game/slither/batch_rules.h"
+#include "clap/game/slither/combinations.h"
+#include "clap/game/slither/tactics.h"
+
+namespace clap::game::slither {
+namespace {
+
+namespace fs = std::filesystem;
+
+uint32_t transform(uint32_t board, int type) {
+  uint32_t transformed = 0;
+  for (; board; board &= board - 1)
+    transformed |= 1u << transform_grid(__builtin_ctz(board), type);
+  return transformed;
+}
+
+// boards of as many stones in the order of their stone lists, which is the
+// order test_generate finds them in
+bool lines_before(uint32_t a, uint32_t b) {
+  const uint32_t differ = a ^ b;
+  return differ && (a & differ & -differ);
+}
+
+}  // namespace
+
+CheckmateGenerator::CheckmateGenerator(const SlitherState& initial,
+                                       const Options& options)
+    : initial(initial), options(options) {
+  if (options.stones < 0 || options.stones > kNumOfGrids)
+    throw std::invalid_argument("stones out of the board");
+  if (options.chunk_size == 0)
+    throw std::invalid_argument("chunk size of 0 ranks");
+}
+
+uint64_t CheckmateGenerator::chunks() const {
+  const uint64_t total = Combinations::binomial(kNumOfGrids, options.stones);
+  return (total + options.chunk_size - 1) / options.chunk_size;
+}
+
+bool CheckmateGenerator::is_checkmate(SlitherState& state,
+                                      uint32_t black) const {
+  for (int i = 0; i < kNumOfGrids; ++i)
+    state.board_[i] = black >> i & 1 ? SlitherState::BLACK
+                                     : SlitherState::EMPTY;
+  bool win;
+  if (options.oracle) {
+    win = Tactics::win_in_one(state);
+  } else {
+    std::vector<std::vector<Action>> paths;
+    win = state.test_action_bool({}, paths, SlitherState::BLACK);
+  }
+  // a board black has connected already is no checkmate
+  return win && !BatchRules::win(black);
+}
+
+std::vector<std::string> CheckmateGenerator::shards(const std::string& dir) {
+  std::vector<std::string> paths;
+  if (!fs::is_directory(dir)) return paths;
+  for (const auto& entry : fs::directory_iterator(dir)) {
+    const std::string name = entry.path().filename().string();
+    if (name.rfind("shard_", 0) == 0 && entry.path().extension() == ".bin")
+      paths.push_back(entry.path().string());
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+std::vector<uint32_t> CheckmateGenerator::read_shard(
+    const std::string& path, Header& header, std::vector<uint32_t>* boards) {
+  std::vector<uint32_t> words;
+  {
+    std::ifstream file(path, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+    words.resize(bytes.size() / sizeof(uint32_t));
+    std::copy(bytes.begin(), bytes.begin() + words.size() * sizeof(uint32_t),
+              reinterpret_cast<char*>(words.data()));
+  }
+
+  std::vector<uint32_t> chunks;
+  constexpr size_t kHeaderWords = sizeof(Header) / sizeof(uint32_t);
+  size_t valid = 0;
+  if (words.size() >= kHeaderWords) {
+    Header found;
+    std::copy_n(words.begin(), kHeaderWords,
+                reinterpret_cast<uint32_t*>(&found));
+    if (found.magic != kMagic || found.version != 1)
+      throw std::runtime_error(path + " is no checkmate shard");
+    if (header.magic == 0) header = found;
+    if (found.stones != header.stones || found.chunk_size != header.chunk_size)
+      throw std::runtime_error(path + " belongs to another database");
+    valid = kHeaderWords;
+    for (size_t pos = valid; pos + 3 <= words.size(); pos = valid) {
+      const uint32_t chunk = words[pos + 1];
+      const uint64_t count = words[pos + 2];
+      const size_t end = pos + 3 + count;
+      if (words[pos] != kBegin || end + 3 > words.size() ||
+          words[end] != kEnd || words[end + 1] != chunk ||
+          words[end + 2] != count)
+        break;
+      chunks.push_back(chunk);
+      if (boards) boards->insert(boards->end(), &words[pos + 3], &words[end]);
+      valid = end + 3;
+    }
+  }
+  if (valid * sizeof(uint32_t) < fs::file_size(path))
+    fs::resize_file(path, valid * sizeof(uint32_t));
+  return chunks;
+}
+
+CheckmateGenerator::Stats CheckmateGenerator::run(const std::string& dir) {
+  const auto begin = std::chrono::steady_clock::now();
+  fs::create_directories(dir);
+  Header header{kMagic, 1, static_cast<uint32_t>(options.stones),
+                static_cast<uint32_t>(options.chunk_size)};
+  std::vector<bool> complete(chunks());
+  Stats stats;
+  stats.chunks = complete.size();
+  for (const auto& path : shards(dir)) {
+    for (const uint32_t chunk : read_shard(path, header, nullptr)) {
+      if (chunk < complete.size() && !complete[chunk]) ++stats.resumed;
+      if (chunk < complete.size()) complete[chunk] = true;
+    }
+  }
+  std::vector<uint32_t> pending;
+  for (uint32_t chunk = 0; chunk < complete.size(); ++chunk)
+    if (!complete[chunk]) pending.push_back(chunk);
+  finished = stats.resumed;
+
+  const Combinations combinations((1u << kNumOfGrids) - 1, options.stones);
+  std::atomic<size_t> next{0};
+  std::atomic<uint64_t> boards{0}, checkmates{0};
+  const auto work = [&](int thread) {
+    const std::string path = dir + "/shard_" + std::to_string(thread) + ".bin";
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    const auto put = [&](uint32_t word) {
+      file.write(reinterpret_cast<const char*>(&word), sizeof(word));
+    };
+    if (fs::file_size(path) == 0)
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    SlitherState state = initial;
+    std::vector<uint32_t> found;
+    uint32_t batch[BatchRules::kBatch];
+    int size = 0;
+    uint64_t valid = 0;
+    // the diagonal rule a batch at a time, the win on the boards it passes
+    const auto evaluate = [&] {
+      uint64_t passed[BatchRules::kWords];
+      BatchRules::diag(batch, size, passed);
+      for (int b = 0; b < size; ++b) {
+        if (!(passed[b / 64] >> (b % 64) & 1)) continue;
+        ++valid;
+        if (is_checkmate(state, batch[b])) found.push_back(batch[b]);
+      }
+      size = 0;
+    };
+    for (size_t i = next++; i < pending.size(); i = next++) {
+      const uint64_t chunk = pending[i];
+      found.clear();
+      valid = 0;
+      combinations.for_each(
+          [&](uint32_t black) {
+            batch[size++] = black;
+            if (size == BatchRules::kBatch) evaluate();
+            return true;
+          },
+          chunk * options.chunk_size, (chunk + 1) * options.chunk_size);
+      evaluate();
+      put(kBegin);
+      put(chunk);
+      put(found.size());
+      file.write(reinterpret_cast<const char*>(found.data()),
+                 found.size() * sizeof(uint32_t));
+      put(kEnd);
+      put(chunk);
+      put(found.size());
+      // the end marker reaches the file before the chunk counts as done
+      file.flush();
+      if (!file) throw std::runtime_error("cannot write " + path);
+      boards += valid;
+      checkmates += found.size();
+      ++finished;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t = 1; t < options.threads; ++t) threads.emplace_back(work, t);
+  work(0);
+  for (auto& thread : threads) thread.join();
+
+  stats.boards = boards;
+  stats.checkmates = checkmates;
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  return stats;
+}
+
+std::vector<uint32_t> CheckmateGenerator::merge(const std::string& dir,
+                                                bool symmetric) {
+  Header header{};
+  std::vector<uint32_t> boards;
+  for (const auto& path : shards(dir)) read_shard(path, header, &boards);
+  if (symmetric) {
+    for (auto& board : boards) {
+      const uint32_t original = board;
+      for (int type = 1; type < kNumTransformations; ++type) {
+        const uint32_t transformed = transform(original, type);
+        if (lines_before(transformed, board)) board = transformed;
+      }
+    }
+  }
+  std::sort(boards.begin(), boards.end(), lines_before);
+  boards.erase(std::unique(boards.begin(), boards.end()), boards.end());
+  return boards;
+}
+
+void CheckmateGenerator::write_text(const std::string& path,
+                                    const std::vector<uint32_t>& boards) {
+  std::ofstream file(path);
+  for (uint32_t board : boards) {
+    for (; board; board &= board - 1) file << __builtin_ctz(board) << " ";
+    file << "\n";
+  }
+  if (!file) throw std::runtime_error("cannot write " + path);
+}
+
+}  // namespace clap::game::slither
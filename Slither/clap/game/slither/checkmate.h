@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+
+// Builds the checkmate database of SlitherState::test_generate: every board of
+// `stones` black stones that passes the diagonal rule, is not yet connected
+// and lets black win in one turn. The boards are ranked in colex order (see
+// Combinations) and cut into chunks of ranks that threads take in turn. Each
+// thread appends its chunks to its own shard file, a chunk framed by begin and
+// end markers, so an interrupted run resumes after the last complete chunk of
+// every shard and drops a torn one.
+//
+// Shard file: a Header, then per chunk
+//   kBegin, chunk, count, count black bitboards, kEnd, chunk, count
+// all uint32_t in host byte order.
+class CheckmateGenerator {
+ public:
+  struct Options {
+    int stones = 6;
+    int threads = 1;
+    uint64_t chunk_size = 1 << 12;
+    // Tactics::win_in_one instead of test_action_bool
+    bool oracle = true;
+  };
+
+  struct Stats {
+    uint64_t chunks = 0;
+    // chunks finished by an earlier run
+    uint64_t resumed = 0;
+    // boards that pass the diagonal rule, and checkmates among them, in the
+    // chunks of this run only
+    uint64_t boards = 0;
+    uint64_t checkmates = 0;
+    double seconds = 0.0;
+  };
+
+  CheckmateGenerator(const SlitherState& initial, const Options& options);
+
+  // fills the shards under `dir` with the chunks they lack
+  Stats run(const std::string& dir);
+  // chunks complete so far, for progress reports while run() works
+  uint64_t done() const { return finished; }
+  uint64_t chunks() const;
+
+  // the checkmates of every shard under `dir`, without duplicates and in the
+  // order test_generate writes them; symmetric keeps one board per class of
+  // the board symmetries, the first of them in that order
+  static std::vector<uint32_t> merge(const std::string& dir, bool symmetric);
+  // one line of black stones per board, as checkmate/checkmate_N.txt
+  static void write_text(const std::string& path,
+                         const std::vector<uint32_t>& boards);
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t stones;
+    uint32_t chunk_size;
+  };
+  static constexpr uint32_t kMagic = 0x4d434c53;  // "SLCM"
+  static constexpr uint32_t kBegin = 0x4e474542;  // "BEGN"
+  static constexpr uint32_t kEnd = 0x4b48434d;    // "MCHK"
+
+  // the complete chunks of a shard, and their boards when asked for; a torn
+  // chunk at the end is cut off. A header with magic 0 takes the shard's,
+  // any other must match it.
+  static std::vector<uint32_t> read_shard(const std::string& path,
+                                          Header& header,
+                                          std::vector<uint32_t>* boards);
+  static std::vector<std::string> shards(const std::string& dir);
+
+  bool is_checkmate(SlitherState& state, uint32_t black) const;
+
+  const SlitherState initial;
+  const Options options;
+  std::atomic<uint64_t> finished{0};
+};
+
+}  // namespace clap::game::slither
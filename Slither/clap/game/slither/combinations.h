@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+
+// The k-subsets of a set of cells as 25-bit masks, in colex order: ascending
+// as numbers once packed into the lowest bits. Subsets follow each other by
+// Gosper's hack, and rank() / at() convert between a subset and its position,
+// so a range of ranks is a slice of the order any thread can walk alone.
+class Combinations {
+ public:
+  // binomial(n, k) for n, k <= kNumOfGrids
+  static uint64_t binomial(int n, int k) {
+    static const auto table = [] {
+      std::array<std::array<uint64_t, kNumOfGrids + 1>, kNumOfGrids + 1> c{};
+      for (int i = 0; i <= kNumOfGrids; ++i) {
+        c[i][0] = 1;
+        for (int j = 1; j <= i; ++j) c[i][j] = c[i - 1][j - 1] + c[i - 1][j];
+      }
+      return c;
+    }();
+    return k < 0 || k > n ? 0 : table[n][k];
+  }
+
+  Combinations(uint32_t cells, int k) : cells(cells), k(k) {
+    for (uint32_t rest = cells; rest; rest &= rest - 1)
+      grids[n++] = __builtin_ctz(rest);
+  }
+
+  uint64_t size() const { return binomial(n, k); }
+
+  // the subset of a rank below size()
+  uint32_t at(uint64_t rank) const {
+    uint32_t packed = 0;
+    int m = n;
+    for (int i = k; i > 0; --i) {
+      while (binomial(--m, i) > rank) {}
+      rank -= binomial(m, i);
+      packed |= uint32_t{1} << m;
+    }
+    return deposit(packed);
+  }
+
+  uint64_t rank(uint32_t subset) const {
+    uint64_t rank = 0;
+    int i = 0;
+    for (int j = 0; j < n; ++j)
+      if (subset >> grids[j] & 1) rank += binomial(j, ++i);
+    return rank;
+  }
+
+  // calls visit(subset) from rank begin until end, or until visit returns
+  // false; returns whether it ran to the end
+  template <class Visit>
+  bool for_each(Visit&& visit, uint64_t begin = 0,
+                uint64_t end = UINT64_MAX) const {
+    end = std::min(end, size());
+    if (begin >= end) return true;
+    uint32_t packed = pack(at(begin));
+    for (uint64_t rank = begin; rank < end; ++rank) {
+      if (!visit(deposit(packed))) return false;
+      if (k > 0) packed = next(packed);
+    }
+    return true;
+  }
+
+  // the next k-subset after `packed` in colex order (Gosper's hack)
+  static uint32_t next(uint32_t packed) {
+    const uint32_t lowest = packed & -packed;
+    const uint32_t ripple = packed + lowest;
+    return ripple | (((packed ^ ripple) >> 2) / lowest);
+  }
+
+ private:
+  // bit j of `packed` to the j-th cell of `cells`
+  uint32_t deposit(uint32_t packed) const {
+#ifdef __BMI2__
+    return _pdep_u32(packed, cells);
+#else
+    uint32_t subset = 0;
+    for (; packed; packed &= packed - 1)
+      subset |= uint32_t{1} << grids[__builtin_ctz(packed)];
+    return subset;
+#endif
+  }
+
+  uint32_t pack(uint32_t subset) const {
+#ifdef __BMI2__
+    return _pext_u32(subset, cells);
+#else
+    uint32_t packed = 0;
+    for (int j = 0; j < n; ++j) packed |= (subset >> grids[j] & 1) << j;
+    return packed;
+#endif
+  }
+
+  uint32_t cells;
+  int k;
+  int n = 0;
+  std::array<int, kNumOfGrids> grids{};
+};
+
+}  // namespace clap::game::slither
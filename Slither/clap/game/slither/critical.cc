@@ -0,0 +1,104 @@
+#include "clap/game/slither/critical.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+namespace {
+
+using Bits = uint32_t;
+
+Bits bit(int point) { return Bits{1} << point; }
+
+class HittingSets {
+ public:
+  HittingSets(Bits required, std::vector<std::pair<int, int>> gaps)
+      : required(required), gaps(std::move(gaps)) {
+    for (const auto& [a, b] : this->gaps) {
+      partners[a] |= bit(b);
+      partners[b] |= bit(a);
+    }
+  }
+
+  std::vector<Bits> run() {
+    search(0, 0, 0);
+    return sets;
+  }
+
+ private:
+  // chosen points every gap before `next` meets, forbidden ones never join
+  void search(size_t next, Bits chosen, Bits forbidden) {
+    while (next < gaps.size() &&
+           (chosen & (bit(gaps[next].first) | bit(gaps[next].second))))
+      ++next;
+    if (next == gaps.size()) {
+      sets.push_back(required | chosen);
+      return;
+    }
+    const auto [a, b] = gaps[next];
+    if (!(forbidden & bit(a)) && minimal(chosen | bit(a)))
+      search(next + 1, chosen | bit(a), forbidden);
+    if (!(forbidden & bit(b)) && minimal(chosen | bit(b)))
+      search(next + 1, chosen | bit(b), forbidden | bit(a));
+  }
+
+  // every chosen point keeps a gap that only it may meet
+  bool minimal(Bits chosen) const {
+    for (Bits rest = chosen; rest; rest &= rest - 1)
+      if (!(partners[__builtin_ctz(rest)] & ~chosen)) return false;
+    return true;
+  }
+
+  const Bits required;
+  const std::vector<std::pair<int, int>> gaps;
+  std::array<Bits, kNumOfGrids> partners{};
+  std::vector<Bits> sets;
+};
+
+}  // namespace
+
+std::vector<std::vector<int>> CriticalSets::of(
+    const std::vector<std::vector<int>>& paths) {
+  Bits required = 0;
+  std::vector<int> singles;
+  std::vector<std::pair<int, int>> pairs;
+  for (const auto& path : paths) {
+    if (path.size() == 1) {
+      required |= bit(path[0]);
+      singles.push_back(path[0]);
+    } else if (path.size() == 2) {
+      pairs.emplace_back(path[0], path[1]);
+    }
+  }
+  if (pairs.empty()) return {singles};
+
+  // a gap of one point twice is a single, and gaps a single meets need no
+  // other point
+  for (const auto& [a, b] : pairs)
+    if (a == b) required |= bit(a);
+  std::vector<std::pair<int, int>> gaps;
+  for (const auto& [a, b] : pairs)
+    if (!(required & (bit(a) | bit(b)))) gaps.emplace_back(a, b);
+
+  std::vector<Bits> sets = HittingSets(required, std::move(gaps)).run();
+  // equal sizes compare at their lowest differing point
+  std::sort(sets.begin(), sets.end(), [](Bits x, Bits y) {
+    const int dx = __builtin_popcount(x), dy = __builtin_popcount(y);
+    if (dx != dy) return dx < dy;
+    return x != y && (x & (x ^ y) & -(x ^ y));
+  });
+  std::vector<std::vector<int>> critical;
+  critical.reserve(sets.size());
+  for (const Bits set : sets) {
+    auto& points = critical.emplace_back();
+    for (Bits rest = set; rest; rest &= rest - 1)
+      points.push_back(__builtin_ctz(rest));
+  }
+  return critical;
+}
+
+}  // namespace clap::game::slither
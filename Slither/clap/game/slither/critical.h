@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace clap::game::slither {
+
+// Critical point sets: the minimal sets of empty points that meet the gaps of
+// every winning path black lacks one or two points of, so white holding all
+// of a set blocks them all. The sets are the minimal hitting sets of the gaps,
+// enumerated on 25-bit masks by branching on the first gap not yet met, and a
+// branch stops as soon as one of its points meets no gap alone.
+class CriticalSets {
+ public:
+  // by size, then in lexicographic order, each in ascending order; without
+  // two-point gaps the one-point gaps as given, the old get_critical output
+  static std::vector<std::vector<int>> of(
+      const std::vector<std::vector<int>>& paths);
+};
+
+}  // namespace clap::game::slither
@@ -0,0 +1,171 @@
+#include "clap/game/slither/perft.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace clap::game::slither {
+namespace {
+
+// splitmix64 finalizer, a bijection so distinct keys never collide
+uint64_t mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+std::mutex registry_mutex;
+
+std::map<std::string, Perft::Generator>& registry() {
+  static std::map<std::string, Perft::Generator> generators = {
+      {"legal_actions",
+       [](const SlitherState& state) { return state.legal_actions(); }},
+  };
+  return generators;
+}
+
+}  // namespace
+
+Perft::Perft(Generator generator, int threads, size_t cache_entries,
+             bool in_place)
+    : generate(std::move(generator)),
+      threads(std::max(1, threads)),
+      in_place(in_place) {
+  if (cache_entries == 0) return;
+  size_t entries = 1;
+  while (entries * 2 <= cache_entries) entries *= 2;
+  mask = entries - 1;
+  table = std::make_unique<Entry[]>(entries);
+}
+
+Perft::Result Perft::run(const SlitherState& root, int depth) {
+  const auto begin = std::chrono::steady_clock::now();
+  Result result;
+  if (depth == 0 || root.is_terminal()) {
+    result.nodes = depth == 0 ? 1 : 0;
+    return result;
+  }
+
+  struct Task {
+    SlitherState state;
+    int depth;
+    int root;
+  };
+  std::vector<Task> tasks;
+  for (const Action action : generate(root)) {
+    tasks.push_back({root, depth - 1, static_cast<int>(tasks.size())});
+    tasks.back().state.apply_action(action);
+    result.divide.emplace_back(action, 0);
+  }
+  // a ply has few actions, split deeper until every thread has some slack
+  while (tasks.size() < 4 * static_cast<size_t>(threads)) {
+    std::vector<Task> split;
+    bool expanded = false;
+    for (auto& task : tasks) {
+      if (task.depth < 2) {
+        split.push_back(std::move(task));
+        continue;
+      }
+      expanded = true;
+      if (task.state.is_terminal()) continue;
+      for (const Action action : generate(task.state)) {
+        split.push_back({task.state, task.depth - 1, task.root});
+        split.back().state.apply_action(action);
+      }
+    }
+    tasks = std::move(split);
+    if (!expanded) break;
+  }
+
+  std::vector<std::atomic<uint64_t>> nodes(result.divide.size());
+  std::atomic<size_t> next{0};
+  std::atomic<uint64_t> hits{0};
+  const auto work = [&] {
+    uint64_t local_hits = 0;
+    for (size_t i = next++; i < tasks.size(); i = next++) {
+      auto& task = tasks[i];
+      nodes[task.root] += count(task.state, task.depth, local_hits);
+    }
+    hits += local_hits;
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; ++i) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+
+  for (size_t i = 0; i < result.divide.size(); ++i) {
+    result.divide[i].second = nodes[i];
+    result.nodes += nodes[i];
+  }
+  result.cache_hits = hits;
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  return result;
+}
+
+uint64_t Perft::count(SlitherState& state, int depth, uint64_t& hits) {
+  if (depth == 0) return 1;
+  if (state.is_terminal()) return 0;
+  // leaves are counted, not visited
+  if (depth == 1) return generate(state).size();
+
+  // position_key takes 54 bits, the depth fits below
+  const uint64_t key = table ? mix(state.position_key() << 8 | depth) : 0;
+  uint64_t nodes = 0;
+  if (table && probe(key, nodes)) {
+    ++hits;
+    return nodes;
+  }
+  nodes = 0;
+  for (const Action action : generate(state)) {
+    if (in_place) {
+      UndoRecord undo;
+      state.make_action(action, undo);
+      nodes += count(state, depth - 1, hits);
+      state.undo_action(undo);
+    } else {
+      SlitherState child = state;
+      child.apply_action(action);
+      nodes += count(child, depth - 1, hits);
+    }
+  }
+  if (table) store(key, nodes);
+  return nodes;
+}
+
+bool Perft::probe(uint64_t key, uint64_t& nodes) const {
+  const Entry& entry = table[key & mask];
+  nodes = entry.nodes.load(std::memory_order_relaxed);
+  return entry.check.load(std::memory_order_relaxed) == (key ^ nodes);
+}
+
+void Perft::store(uint64_t key, uint64_t nodes) {
+  Entry& entry = table[key & mask];
+  entry.nodes.store(nodes, std::memory_order_relaxed);
+  entry.check.store(key ^ nodes, std::memory_order_relaxed);
+}
+
+void Perft::add_generator(const std::string& name, Generator generator) {
+  std::lock_guard lock(registry_mutex);
+  registry()[name] = std::move(generator);
+}
+
+Perft::Generator Perft::generator(const std::string& name) {
+  std::lock_guard lock(registry_mutex);
+  const auto it = registry().find(name);
+  if (it == registry().end())
+    throw std::invalid_argument("unknown move generator " + name);
+  return it->second;
+}
+
+std::vector<std::string> Perft::generators() {
+  std::lock_guard lock(registry_mutex);
+  std::vector<std::string> names;
+  for (const auto& [name, generator] : registry()) names.push_back(name);
+  return names;
+}
+
+}  // namespace clap::game::slither
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+
+// Counts the leaves of the move tree to a fixed depth, the exact check that a
+// move generator matches the rules. Every choose, move and place counts as a
+// ply and terminal states have no children. The subtrees under the first
+// plies are shared among threads, and counts of transposed subtrees are kept
+// in a lockless table. In place, each thread walks its subtrees in one state
+// by make/unmake instead of copying every child.
+class Perft {
+ public:
+  // actions of a non-terminal state, in any order
+  using Generator = std::function<std::vector<Action>(const SlitherState&)>;
+
+  struct Result {
+    uint64_t nodes = 0;
+    // nodes under every root action, in generator order
+    std::vector<std::pair<Action, uint64_t>> divide;
+    uint64_t cache_hits = 0;
+    double seconds = 0.0;
+  };
+
+  // cache_entries is rounded down to a power of two, 0 disables the table
+  Perft(Generator generator, int threads, size_t cache_entries,
+        bool in_place = false);
+  Result run(const SlitherState& root, int depth);
+
+  // named move generators for cross-checks, "legal_actions" is the reference
+  static void add_generator(const std::string& name, Generator generator);
+  static Generator generator(const std::string& name);
+  static std::vector<std::string> generators();
+
+ private:
+  // (key ^ nodes, nodes), so a torn write never passes as a hit
+  struct Entry {
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> nodes{0};
+  };
+
+  uint64_t count(SlitherState& state, int depth, uint64_t& hits);
+  bool probe(uint64_t key, uint64_t& nodes) const;
+  void store(uint64_t key, uint64_t nodes);
+
+  Generator generate;
+  int threads;
+  bool in_place;
+  size_t mask = 0;
+  std::unique_ptr<Entry[]> table;
+};
+
+}  // namespace clap::game::slither
@@ -0,0 +1,73 @@
+#include "clap/game/slither/prune.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "clap/game/slither/tactics.h"
+
+namespace clap::game::slither {
+
+// boards per next_batch; large enough that the stream costs nothing
+constexpr int kBatchSize = 1 << 12;
+
+std::vector<PruneStats> PruneAnalysis::run(const SlitherState& initial,
+                                           const std::vector<uint64_t>& boards,
+                                           int threads, bool brute_force) {
+  for (const uint64_t black : boards)
+    if (black >> kNumOfGrids)
+      throw std::invalid_argument("a board outside the grid");
+  if (threads <= 0)
+    threads = std::max(1U, std::thread::hardware_concurrency());
+
+  std::vector<PruneStats> stats(boards.size());
+  std::atomic<size_t> next{0};
+  const auto work = [&] {
+    for (size_t i = next++; i < boards.size(); i = next++)
+      stats[i] = analyze(initial, boards[i], brute_force);
+  };
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; ++t) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+  return stats;
+}
+
+PruneStats PruneAnalysis::analyze(const SlitherState& initial, uint64_t black,
+                                  bool brute_force) {
+  // play_manual 0 X X <cell> per stone
+  SlitherState state = initial;
+  int stones = 0;
+  for (; black; black &= black - 1, ++stones) {
+    state.manual_action(empty_index, SlitherState::BLACK);
+    state.manual_action(empty_index, SlitherState::BLACK);
+    state.manual_action(__builtin_ctzll(black), SlitherState::BLACK);
+  }
+
+  PruneStats stats;
+  // test_board(M) is black's one-turn win on M, black to move
+  SlitherState start = initial;
+  const auto black_wins = [&](const std::vector<int>& M) {
+    if (brute_force) return state.test_board(M);
+    std::copy(M.begin(), M.end(), start.board_.begin());
+    return Tactics::win_in_one(start);
+  };
+  auto stream =
+      state.stream_noBlock(state.getboard(), stones, state.critical_points());
+  for (auto batch = stream->next_batch(kBatchSize); !batch.empty();
+       batch = stream->next_batch(kBatchSize)) {
+    stats.kept += batch.size();
+    if (!stats.counterexample.empty()) continue;
+    for (const auto& M : batch) {
+      if (!black_wins(M)) {
+        stats.counterexample = M;
+        break;
+      }
+    }
+  }
+  stats.valid = stream->valid();
+  return stats;
+}
+
+}  // namespace clap::game::slither
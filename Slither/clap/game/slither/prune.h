@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "clap/game/game.h"
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+
+// CLI_agent.test_prune for a batch of checkmate boards, on threads that take
+// the boards in turn. Each board is played onto `initial` as test_prune plays
+// it, and every white board stream_noBlock keeps for its critical points is
+// tried until black cannot win on one; the rest are only counted.
+class PruneAnalysis {
+ public:
+  // boards as masks of black stones; threads 0 for one per core
+  static std::vector<PruneStats> run(const SlitherState& initial,
+                                     const std::vector<uint64_t>& boards,
+                                     int threads, bool brute_force);
+
+ private:
+  static PruneStats analyze(const SlitherState& initial, uint64_t black,
+                            bool brute_force);
+};
+
+}  // namespace clap::game::slither
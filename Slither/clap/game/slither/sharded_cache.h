@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace clap::game::slither {
+
+// A bounded map shared by threads, for memoized position analyses. Keys are
+// spread over shards by a mixed hash, each shard with its own lock, and a full
+// shard drops its oldest entry. Shards are allocated once and live as long as
+// the cache, so resize is safe while others use it.
+template <class Key, class Value, int kShards = 64>
+class ShardedCache {
+ public:
+  // up to `entries` results, 0 disables the cache and keeps the results.
+  // The first nonzero size is final: a later different size would free
+  // shards other threads may be in, so it only enables the cache and warns.
+  void resize(size_t entries) {
+    std::lock_guard lock(resize_mutex);
+    if (entries == 0) {
+      active.store(false, std::memory_order_relaxed);
+      return;
+    }
+    if (!shards) {
+      size = entries;
+      capacity = (entries + kShards - 1) / kShards;
+      shards = std::make_unique<Shard[]>(kShards);
+    } else if (entries != size) {
+      std::cerr << "cache keeps " << size << " entries, ignoring " << entries
+                << std::endl;
+    }
+    // publishes shards and capacity to the threads that see it enabled
+    active.store(true, std::memory_order_release);
+  }
+  bool enabled() const { return active.load(std::memory_order_acquire); }
+
+  std::optional<Value> find(const Key& key) const {
+    Shard& shard = shard_of(key);
+    std::lock_guard lock(shard.mutex);
+    const auto it = shard.values.find(key);
+    if (it == shard.values.end()) return std::nullopt;
+    return it->second;
+  }
+
+  void insert(const Key& key, Value value) {
+    Shard& shard = shard_of(key);
+    std::lock_guard lock(shard.mutex);
+    if (!shard.values.emplace(key, std::move(value)).second) return;
+    shard.order.push_back(key);
+    if (shard.order.size() > capacity) {
+      shard.values.erase(shard.order.front());
+      shard.order.pop_front();
+    }
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<Key, Value> values;
+    // insertion order, for eviction
+    std::deque<Key> order;
+  };
+
+  Shard& shard_of(const Key& key) const {
+    // splitmix64 finalizer, so nearby keys land in different shards
+    uint64_t x = static_cast<uint64_t>(key);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return shards[(x ^ (x >> 31)) % kShards];
+  }
+
+  std::mutex resize_mutex;
+  std::atomic<bool> active{false};
+  std::unique_ptr<Shard[]> shards;
+  size_t size = 0;
+  size_t capacity = 0;
+};
+
+}  // namespace clap::game::slither
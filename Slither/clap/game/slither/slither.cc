@@ -1,4 +1,11 @@
 #include "clap/game/slither/slither.h"
+#include "clap/game/board_file.h"
+#include "clap/game/slither/batch_rules.h"
+#include "clap/game/slither/combinations.h"
+#include "clap/game/slither/critical.h"
+#include "clap/game/slither/prune.h"
+#include "clap/game/slither/sharded_cache.h"
+#include "clap/game/slither/tactics.h"
 #include <algorithm>
 #include <iomanip>
 #include <numeric>
@@ -12,6 +19,9 @@
 #include <stdlib.h>
 #include <cstdlib>
 #include <ctime>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace clap::game::slither {
 
@@ -130,6 +140,42 @@ void SlitherState::apply_action(const Action &action) {
 	}
 }
 
+namespace {
+// UndoRecord slots of SlitherState
+enum UndoSlot { kAction, kTurn, kSkip, kWinner, kLastHistory, kSrcPiece, kDstPiece };
+}  // namespace
+
+void SlitherState::make_action(const Action &action, UndoRecord &undo) {
+  auto &data = undo.data;
+  data[kAction] = action;
+  data[kTurn] = turn_;
+  data[kSkip] = skip_;
+  data[kWinner] = winner_;
+  data[kLastHistory] = history_.empty() ? -1 : history_.back();
+  // the cells a move or a placement writes
+  const int src = turn_ % 3 == 1 ? history_.back() : empty_index;
+  data[kSrcPiece] = src < kNumOfGrids ? board_[src] : static_cast<short>(EMPTY);
+  data[kDstPiece] =
+      action < kNumOfGrids ? board_[action] : static_cast<short>(EMPTY);
+  apply_action(action);
+}
+
+void SlitherState::undo_action(const UndoRecord &undo) {
+  const auto &data = undo.data;
+  const Action action = data[kAction];
+  history_.pop_back();
+  // a skipped move also rewrites the chosen piece
+  if (data[kLastHistory] != -1) history_.back() = data[kLastHistory];
+  if (action < kNumOfGrids) {
+    if (data[kTurn] % 3 == 1 && data[kLastHistory] < kNumOfGrids)
+      board_[data[kLastHistory]] = data[kSrcPiece];
+    if (data[kTurn] % 3 != 0) board_[action] = data[kDstPiece];
+  }
+  turn_ = data[kTurn];
+  skip_ = data[kSkip];
+  winner_ = data[kWinner];
+}
+
 void SlitherState::manual_action(const Action &action, Player p) {
  	if (turn_ % 3 == 0) {  // choose
 		if (p != current_player()) turn_ += 3;
@@ -191,92 +237,44 @@ void SlitherState::manual_action(const Action &action, Player p) {
 // 11/7 modified
 
 std::vector<std::vector<int>> SlitherState::get_critical(std::vector<std::vector<int>> pathes) {
-	std::vector<std::vector<int>> pathes_1, pathes_2, all_critical, all_pathes;
-	for(auto& path: pathes){
-		if(path.size() == 1) pathes_1.push_back(path);
-		else if(path.size() == 2) pathes_2.push_back(path);
-	}
-
-	// CLI_agent.py Line: 259 - 287
-	if(pathes_2.size()){
-		// CLI_agent.py Line: 260 - 261
-		std::stack<std::pair<std::set<int> ,int>> s;
-		std::set<int> emp;
-		s.push(std::make_pair(emp, 0));
-		while(!s.empty()){
-			std::set<int> combination = s.top().first;
-			int ind = s.top().second;
-			s.pop();
-			if(ind == pathes_2.size()) {
-				all_critical.push_back(std::vector<int>(combination.begin(), combination.end()));
-				continue;
-			}
-			for(auto &point: pathes_2[ind]){
-				std::set<int> tmp = combination;
-				tmp.insert(point);
-				s.push(std::make_pair(tmp, ind+1));
-			}
-		}
-
-		// CLI_agent.py Line: 263 - 268
-		int max_length = 0;
-		for(int i = 0;i<all_critical.size();i++){
-			for(auto& point: pathes_1){
-				if(std::find(all_critical[i].begin(), all_critical[i].end(), point[0]) == all_critical[i].end()){
-					all_critical[i].push_back(point[0]);
-				}
-			}
-			if(max_length < all_critical[i].size()) max_length = all_critical[i].size();
-		}
-
-		// CLI_agent.py Line: 269 - 271
-		std::vector<std::set<std::set<int>>> pathes_n;
-		for(int i = 1;i<max_length+1;i++){
-			std::set<std::set<int>> tmp;
-			for(auto& j:all_critical){
-				if(j.size() == i){
-					std::set<int> tmp_j(j.begin(), j.end());
-					tmp.insert(tmp_j);
-				}
-			}
-			pathes_n.push_back(tmp);
-		}
-
-		// CLI_agent.py Line: 273 - 278
-		for(int i =0;i<max_length-1;i++){
-			for(int j = i+1;j<max_length;j++){
-				for(auto& setb: pathes_n[i]){
-					std::set<std::set<int>> tmp_pathes_j(pathes_n[j].begin(), pathes_n[j].end());
-					for(auto& seta: tmp_pathes_j){
-						if(std::includes(seta.begin(), seta.end(), setb.begin(), setb.end())) {	// b is a subset of a
-							pathes_n[j].erase(seta);
-						}
-					}
-				}
-			}
-		}
-
-		// CLI_agent.py Line: 280 - 283
-		for(auto& path_n: pathes_n) {
-			if(path_n.size() > 0) {
-				for(auto& p: path_n) {
-					std::vector<int> tmp_p(p.begin(), p.end());
-					all_pathes.push_back(tmp_p);
-				}
-			}
-		}
+	return CriticalSets::of(pathes);
+}
 
-	}
-	// CLI_agent.py Line: 285 - 287
-	else {
-		std::vector<int> tmp_p;
-		for(auto& p: pathes_1) {
-			tmp_p.push_back(p[0]);
-		}
-		all_pathes.push_back(tmp_p);
-	}
+namespace {
+// shared by all states, see SlitherGame::set_cache_entries
+// critical points by black stones
+ShardedCache<uint32_t, std::vector<std::vector<int>>> critical_cache;
+// blockability by position_key, which leaves out only the winner
+ShardedCache<uint64_t, bool> can_block_cache;
+ShardedCache<uint64_t, bool> block_in_one_cache;
+
+template <class Compute>
+bool memoized(ShardedCache<uint64_t, bool> &cache, const SlitherState &state,
+              Compute &&compute) {
+	if (!cache.enabled() || state.is_terminal()) return compute();
+	const uint64_t key = state.position_key();
+	if (auto result = cache.find(key)) return *result;
+	const bool result = compute();
+	cache.insert(key, result);
+	return result;
+}
+}  // namespace
+
+std::vector<std::vector<int>> SlitherState::critical_points() {
+	if (!critical_cache.enabled()) return get_critical(match_WP());
+	uint32_t black = 0;
+	for (int i = 0; i < kNumOfGrids; i++)
+		if (board_[i] == BLACK) black |= 1u << i;
+	if (auto critical = critical_cache.find(black)) return *critical;
+	auto critical = get_critical(match_WP());
+	critical_cache.insert(black, critical);
+	return critical;
+}
 
-	return all_pathes;
+void SlitherGame::set_cache_entries(size_t entries) const {
+	critical_cache.resize(entries);
+	can_block_cache.resize(entries);
+	block_in_one_cache.resize(entries);
 }
 
 std::vector<int> SlitherState::getboard() {
@@ -289,56 +287,28 @@ std::vector<int> SlitherState::getboard() {
 
 
 std::vector<std::vector<Action>> SlitherState::test_action(std::vector<Action> path, std::vector<std::vector<Action>> &pathes, Player p) {
-	int cur_turn = path.size();
-	// std::cout << cur_turn << '\n';
-	if(cur_turn == 3) {
-		if(winner_ != -1) {
-			// path.push_back(winner_);
-			pathes.push_back(path);
-			return pathes;
-		}
-		return pathes;
-	}
-	if (p != current_player()) turn_ += 3;
-	// int num_of_win = 0;
-	std::vector<Action> actions = legal_actions();
-	for(auto action: actions) {
-		auto copy_path = path;
-		copy_path.push_back(action);
-		SlitherState cur_state = SlitherState(*this);
-		cur_state.apply_action(action);
-		cur_state.test_action(copy_path, pathes, p);
-	}
+	// lines of 3 actions in all that end in a win, searched in place
+	depth_first(*this, 3 - static_cast<int>(path.size()), path,
+		[&](SlitherState &state, const std::vector<Action> &line) {
+			if (line.size() == 3) {
+				if (state.winner_ != -1) pathes.push_back(line);
+				return Visit::kPrune;
+			}
+			if (p != state.current_player()) state.turn_ += 3;
+			return Visit::kDescend;
+		});
 	return pathes;
 }
 
-bool SlitherState::test_action_bool(std::vector<Action> path, std::vector<std::vector<Action>> &pathes, Player p) {
-	int cur_turn = path.size();
-	// std::cout << cur_turn << '\n';
-	if(cur_turn == 3) {
-		// for (auto& p: path) {
-		// 	std::cout << p << ' ';
-		// } std::cout << winner_ << '\n';
-		if(winner_ != -1) {
-			// path.push_back(winner_);
-			// pathes.push_back(path);
-			return true;
-		}
-		return false;
-	}
-	if (p != current_player()) turn_ += 3;
-	// int num_of_win = 0;
-	std::vector<Action> actions = legal_actions();
-	for(auto action: actions) {
-		auto copy_path = path;
-		copy_path.push_back(action);
-		SlitherState cur_state = SlitherState(*this);
-		cur_state.apply_action(action);
-		if (cur_state.test_action_bool(copy_path, pathes, p)){
-			return true;
-		}
-	}
-	return false;
+bool SlitherState::test_action_bool(std::vector<Action> path, [[maybe_unused]] std::vector<std::vector<Action>> &pathes, Player p) {
+	// test_action that stops at the first win
+	return !depth_first(*this, 3 - static_cast<int>(path.size()), path,
+		[&](SlitherState &state, const std::vector<Action> &line) {
+			if (line.size() == 3)
+				return state.winner_ != -1 ? Visit::kStop : Visit::kPrune;
+			if (p != state.current_player()) state.turn_ += 3;
+			return Visit::kDescend;
+		});
 }
 
 bool SlitherState::test_board(std::vector<Action> board) {
@@ -372,21 +342,8 @@ bool SlitherState::check_redundent(std::vector<int> M, int num){
 
 //check win
 bool SlitherState::check_win(std::vector<int> M, int color){
-    std::vector<bool> m(25, false);
-    for(int i=0;i<20;i++){
-        if(i<5&&M[i]==color) m[i]=true;
-        if(m[i]==true) {
-            if(M[i+5]==color&&m[i+5]==false){
-                m[i+5]=true;
-                if(i%5!=0&&M[i+4]==color&&m[i+4]==false) m[i+4]==true;
-                if(i%5!=4&&M[i+6]==color&&m[i+6]==false) m[i+6]==true;
-            }
-        }
-    }
-    for(int i=20;i<25;i++){
-        if(m[i]) return true;
-    }
-    return false;
+	// a column full of color, see BatchRules::win
+	return BatchRules::win(BatchRules::mask(M, color));
 }
 
 // std::pair<int, int> * SlitherState::check_win(std::vector<int> M){
@@ -421,17 +378,7 @@ bool SlitherState::check_win(std::vector<int> M, int color){
 
 // check diag
 bool SlitherState::check_diag(std::vector<int> M, int color){
-    for(int i=0;i<20;i++){
-        if(M[i]==color){
-            if(i%5!=0){
-                if(M[i+4]==color&&M[i+5]!=color&&M[i-1]!=color) return false;
-            }
-            if(i%5!=4){
-                if(M[i+6]==color&&M[i+5]!=color&&M[i+1]!=color) return false;
-            }
-        }
-    }
-    return true;
+	return BatchRules::diag(BatchRules::mask(M, color));
 }
 
 bool SlitherState::check_blocked(std::vector<int> M, std::vector<std::vector<int>>CPs){
@@ -498,6 +445,23 @@ uint64_t SlitherState::convert_to_uint64_t(std::vector<int> M) {
     return board;
 }
 
+uint64_t SlitherState::position_key() const {
+	uint64_t key = 0;
+	for (int i = 0; i < kNumOfGrids; ++i) key = key * 3 + board_[i];  // < 2^40
+	key = key << 3 | (turn_ % 6);
+	key = key << 1 | skip_;
+	// the pending choose & move, read by the move and place phases
+	const int phase = turn_ % 3;
+	const int n = history_.size();
+	const int src = phase == 2   ? history_[n - 2]
+	                : phase == 1 ? history_[n - 1]
+	                             : 0;
+	const int dst = phase == 2 ? history_[n - 1] : 0;
+	key = key << 5 | src;
+	key = key << 5 | dst;
+	return key;
+}
+
 // void SlitherState::store_TT(std::unordered_map<uint64_t, int> &TT, std::vector<int> M, int label){
 // 	uint64_t board = convert_to_uint64_t(M);
 //     TT[board] = {label};
@@ -514,9 +478,20 @@ uint64_t SlitherState::convert_to_uint64_t(std::vector<int> M) {
 //     }
 // }
 
-bool SlitherState::check_can_block(){
+bool SlitherState::win_in_one() { return Tactics::win_in_one(*this); }
+
+bool SlitherState::block_in_one() {
+	return memoized(block_in_one_cache, *this,
+	                [&] { return Tactics::block_in_one(*this); });
+}
+
+bool SlitherState::check_can_block() {
+	return memoized(can_block_cache, *this, [&] { return find_block(); });
+}
+
+bool SlitherState::find_block(){
     std::vector<int> M = getboard();
-	std::vector<std::vector<int>> pos = get_critical(match_WP());
+	std::vector<std::vector<int>> pos = critical_points();
 	if(pos.size() == 0) return true;
 	std::vector<int> dir = {-5, -1, 1, 5};
     for(int j=0;j<pos.size();j++){
@@ -611,150 +586,167 @@ bool SlitherState::check_can_block(){
 }
 
 
+namespace {
+
+// every winning path, shortest first, read once: winning_path/winning_path.bin
+// (see slither_boards.cc) when there is one, the text files otherwise
+const std::vector<uint64_t>& winning_paths() {
+	static const std::vector<uint64_t> paths = [] {
+		const std::string folder = "./winning_path/";
+		if (std::ifstream(folder + "winning_path.bin")) {
+			const BoardFile file(folder + "winning_path.bin");
+			return std::vector<uint64_t>(file.masks(), file.masks() + file.size());
+		}
+		std::vector<uint64_t> paths;
+		for (int i = 5; i <= kNumOfGrids + 1; i++) {
+			const std::string filename = folder + std::to_string(i) + ".txt";
+			if (!std::ifstream(filename)) continue;
+			const auto more = BoardFile::read_text(filename);
+			paths.insert(paths.end(), more.begin(), more.end());
+		}
+		return paths;
+	}();
+	return paths;
+}
+
+}  // namespace
+
 std::vector<std::vector<int>> SlitherState::match_WP(){
 	std::vector<int> M = getboard();
 	int num = 0;
 	for(int i=0;i<25;i++){
 		if(M[i]==0) num++;
 	}
-	std::string folder = "./winning_path/";
 	std::vector<std::vector<int>> pathes;
-	for(int i=5;i<=num+1;i++){
-		std::string filename = folder+std::to_string(i)+".txt";
-		std::ifstream file;
-		file.open(filename);
-
-		std::string line;
-        while (std::getline(file, line)) { 
-			bool miss_one = false;
-			bool miss_two = false;
-			bool is_wp = true;
-			std::stringstream ss(line);
-			std::string point;
-			std::vector<int> miss_points;
-			std::vector<int> wp;
-			while (std::getline(ss, point, ' ')) {
-				if(M[std::stoi(point)] != 0){
-					// std::cout << point << "\n";
-					if(miss_two) 
-					{
-						is_wp = false;
-					}
-					else if(miss_one) {
-						miss_two = true;
-						miss_points.push_back(std::stoi(point));
-					}
-					else {
-						miss_one = true;
-						miss_points.push_back(std::stoi(point));
-					}
-				}/* else if (M[std::stoi(point)]==1) {
+	for (const uint64_t path : winning_paths()) {
+		// paths longer than the stones plus one cannot be a move away
+		if (__builtin_popcountll(path) > num + 1) continue;
+		bool miss_one = false;
+		bool miss_two = false;
+		bool is_wp = true;
+		std::vector<int> miss_points;
+		std::vector<int> wp;
+		for (uint64_t rest = path; rest; rest &= rest - 1) {
+			const int point = __builtin_ctzll(rest);
+			if(M[point] != 0){
+				// std::cout << point << "\n";
+				if(miss_two) 
+				{
 					is_wp = false;
-				} */
-				else{
-					wp.push_back(std::stoi(point));
 				}
+				else if(miss_one) {
+					miss_two = true;
+					miss_points.push_back(point);
+				}
+				else {
+					miss_one = true;
+					miss_points.push_back(point);
+				}
+			}/* else if (M[point]==1) {
+				is_wp = false;
+			} */
+			else{
+				wp.push_back(point);
 			}
-			// for(int i=0;i<pathes.size();i++){
-			// 	for(int j=0;j<pathes[i].size();j++){
-			// 		std::cout << pathes[i][j] << " ";
-			// 	}
-			// 	std::cout << "\n";
-			// }
-			if(is_wp){
-				if(miss_two){
-					bool can_move = false;
-					for(int i=0;i<2;i++){
-						if(miss_points[i]/5>0&&miss_points[i]%5!=0&&M[miss_points[i]-6]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]-6)==wp.end()){
-							std::swap(M[miss_points[i]-6], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]-6], M[miss_points[i]]);
-						}
-						if(miss_points[i]/5>0&&M[miss_points[i]-5]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]-5)==wp.end()){
-							std::swap(M[miss_points[i]-5], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]-5], M[miss_points[i]]);
+		}
+		// for(int i=0;i<pathes.size();i++){
+		// 	for(int j=0;j<pathes[i].size();j++){
+		// 		std::cout << pathes[i][j] << " ";
+		// 	}
+		// 	std::cout << "\n";
+		// }
+		if(is_wp){
+			if(miss_two){
+				bool can_move = false;
+				for(int i=0;i<2;i++){
+					if(miss_points[i]/5>0&&miss_points[i]%5!=0&&M[miss_points[i]-6]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]-6)==wp.end()){
+						std::swap(M[miss_points[i]-6], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
-						if(miss_points[i]/5>0&&miss_points[i]%5!=4&&M[miss_points[i]-4]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]-4)==wp.end()){
-							std::swap(M[miss_points[i]-4], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]-4], M[miss_points[i]]);
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]-6], M[miss_points[i]]);
+					}
+					if(miss_points[i]/5>0&&M[miss_points[i]-5]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]-5)==wp.end()){
+						std::swap(M[miss_points[i]-5], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
-						if(miss_points[i]%5!=0&&M[miss_points[i]-1]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]-1)==wp.end()){
-							std::swap(M[miss_points[i]-1], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]-1], M[miss_points[i]]);
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]-5], M[miss_points[i]]);
+					}
+					if(miss_points[i]/5>0&&miss_points[i]%5!=4&&M[miss_points[i]-4]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]-4)==wp.end()){
+						std::swap(M[miss_points[i]-4], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
-						if(miss_points[i]%5!=4&&M[miss_points[i]+1]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]+1)==wp.end()){
-							std::swap(M[miss_points[i]+1], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]+1], M[miss_points[i]]);
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]-4], M[miss_points[i]]);
+					}
+					if(miss_points[i]%5!=0&&M[miss_points[i]-1]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]-1)==wp.end()){
+						std::swap(M[miss_points[i]-1], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
-						if(miss_points[i]/5<4&&miss_points[i]%5!=0&&M[miss_points[i]+4]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]+4)==wp.end()){
-							std::swap(M[miss_points[i]+4], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]+4], M[miss_points[i]]);
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]-1], M[miss_points[i]]);
+					}
+					if(miss_points[i]%5!=4&&M[miss_points[i]+1]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]+1)==wp.end()){
+						std::swap(M[miss_points[i]+1], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
-						if(miss_points[i]/5<4&&M[miss_points[i]+5]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]+5)==wp.end()){
-							std::swap(M[miss_points[i]+5], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]+5], M[miss_points[i]]);
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]+1], M[miss_points[i]]);
+					}
+					if(miss_points[i]/5<4&&miss_points[i]%5!=0&&M[miss_points[i]+4]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]+4)==wp.end()){
+						std::swap(M[miss_points[i]+4], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
-						if(miss_points[i]/5<4&&miss_points[i]%5!=4&&M[miss_points[i]+6]==0
-							&&std::find(wp.begin(), wp.end(), miss_points[i]+6)==wp.end()){
-							std::swap(M[miss_points[i]+6], M[miss_points[i]]);
-							M[miss_points[1-i]] = 0;
-							if(check_diag(M, 0)){
-								can_move=true;
-							}
-							M[miss_points[1-i]] = 2;
-							std::swap(M[miss_points[i]+6], M[miss_points[i]]);
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]+4], M[miss_points[i]]);
+					}
+					if(miss_points[i]/5<4&&M[miss_points[i]+5]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]+5)==wp.end()){
+						std::swap(M[miss_points[i]+5], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
 						}
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]+5], M[miss_points[i]]);
 					}
-					if(can_move){
-						pathes.push_back(miss_points);
+					if(miss_points[i]/5<4&&miss_points[i]%5!=4&&M[miss_points[i]+6]==0
+						&&std::find(wp.begin(), wp.end(), miss_points[i]+6)==wp.end()){
+						std::swap(M[miss_points[i]+6], M[miss_points[i]]);
+						M[miss_points[1-i]] = 0;
+						if(check_diag(M, 0)){
+							can_move=true;
+						}
+						M[miss_points[1-i]] = 2;
+						std::swap(M[miss_points[i]+6], M[miss_points[i]]);
 					}
-				} else {
+				}
+				if(can_move){
 					pathes.push_back(miss_points);
 				}
+			} else {
+				pathes.push_back(miss_points);
 			}
-        }
-        file.close();
+		}
 	}
 	// for(auto path:pathes) {
 	// 	for(auto mp:path) {
@@ -869,6 +861,98 @@ void SlitherState::DFS_WP(std::vector<int> &M, int cnt, int max, int num){
 	
 // }
 
+namespace {
+// The boards M with cnt of `cells` set to `piece` that keep accepts, in colex
+// order of the cells, resumed from the last rank at every batch. keep sees
+// BatchRules::kBatch boards at a time as masks of `piece`, and marks the ones
+// that pass the diagonal rule and the ones to keep.
+class CombinationStream final : public BoardStream {
+ public:
+  using Keep = std::function<void(const uint32_t *stones, int n,
+                                  uint64_t *valid, uint64_t *kept)>;
+
+  CombinationStream(std::vector<int> M, uint32_t cells, int cnt, int piece,
+                    Keep keep)
+      : combinations(cells, cnt), M(std::move(M)), base(this->M),
+        fixed(BatchRules::mask(base, piece)), piece(piece),
+        keep(std::move(keep)) {}
+
+  std::vector<std::vector<int>> next_batch(int size) override {
+    std::vector<std::vector<int>> batch;
+    uint32_t subsets[BatchRules::kBatch], stones[BatchRules::kBatch];
+    const size_t wanted = std::max(size, 0);
+    while (batch.size() < wanted) {
+      int n = 0;
+      combinations.for_each([&](uint32_t subset) {
+        subsets[n] = subset;
+        stones[n++] = fixed | subset;
+        return true;
+      }, rank, rank + BatchRules::kBatch);
+      if (n == 0) break;
+      uint64_t valid[BatchRules::kWords], kept[BatchRules::kWords];
+      keep(stones, n, valid, kept);
+      // boards past the last one taken come again with the next batch
+      int i = 0;
+      for (; i < n && batch.size() < wanted; ++i) {
+        valid_ += valid[i / 64] >> (i % 64) & 1;
+        if (!(kept[i / 64] >> (i % 64) & 1)) continue;
+        for (uint32_t rest = subsets[i]; rest; rest &= rest - 1)
+          M[__builtin_ctz(rest)] = piece;
+        batch.push_back(M);
+        for (uint32_t rest = subsets[i]; rest; rest &= rest - 1)
+          M[__builtin_ctz(rest)] = base[__builtin_ctz(rest)];
+      }
+      rank += i;
+    }
+    return batch;
+  }
+
+  int64_t valid() const override { return valid_; }
+
+ private:
+  const Combinations combinations;
+  std::vector<int> M;
+  const std::vector<int> base;
+  // stones of `piece` on the board before any is placed
+  const uint32_t fixed;
+  const int piece;
+  const Keep keep;
+  uint64_t rank = 0;
+  int64_t valid_ = 0;
+};
+}  // namespace
+
+std::unique_ptr<BoardStream> SlitherState::stream_noBlock(std::vector<int> M, int cnt, std::vector<std::vector<int>> CPs) {
+	// white on cnt of the cells black does not hold, as DFS_noBlock places it
+	uint32_t cells = 0;
+	for (int i = 0; i < kNumOfGrids; i++)
+		if (M[i] != BLACK) cells |= 1u << i;
+	return std::make_unique<CombinationStream>(
+		std::move(M), cells, cnt, WHITE,
+		[sets = BatchRules::masks(CPs)](const uint32_t *white, int n, uint64_t *valid, uint64_t *kept) {
+			uint64_t blocked[BatchRules::kWords], win[BatchRules::kWords];
+			BatchRules::diag(white, n, valid);
+			BatchRules::blocked(white, n, sets, blocked);
+			BatchRules::win(white, n, win);
+			for (int w = 0; w < (n + 63) / 64; w++)
+				kept[w] = valid[w] & ~blocked[w] & ~win[w];
+		});
+}
+
+std::unique_ptr<BoardStream> SlitherState::stream_generate(int cnt) {
+	return std::make_unique<CombinationStream>(
+		std::vector<int>(kNumOfGrids, EMPTY), (1u << kNumOfGrids) - 1, cnt, BLACK,
+		[](const uint32_t *black, int n, uint64_t *valid, uint64_t *kept) {
+			BatchRules::diag(black, n, valid);
+			std::copy(valid, valid + (n + 63) / 64, kept);
+		});
+}
+
+std::vector<PruneStats> SlitherState::prune_analysis(const std::vector<uint64_t>& boards, int threads, bool brute_force) {
+	const StatePtr initial = game()->new_initial_state();
+	return PruneAnalysis::run(static_cast<const SlitherState &>(*initial), boards, threads, brute_force);
+}
+
 std::vector<std::vector<int>> SlitherState::generate(int cnt){
 	std::vector<std::vector<int>> MM;
 	std::vector<int> M (25, 2);
@@ -1528,27 +1612,46 @@ int SlitherGame::num_distinct_actions() const {
   return kPolicyDim;
 }
 std::vector<int> SlitherGame::observation_tensor_shape() const {
-  return {4, kBoardSize, kBoardSize};
+  return {kObservationPlanes, kBoardSize, kBoardSize};
 }
 
 StatePtr SlitherGame::new_initial_state() const {
   return std::make_unique<SlitherState>(shared_from_this());
 }
 
-int SlitherGame::num_transformations() const { return 4; }
+int SlitherGame::num_transformations() const { return kNumTransformations; }
+
+namespace {
+
+// gather every kNumOfGrids plane of `data` through `table` in place
+void gather_planes(float *data, const int planes,
+                   const std::array<int, kNumOfGrids> &table,
+                   const int stride = kNumOfGrids) {
+  std::array<float, kNumOfGrids> plane;
+  for (int p = 0; p < planes; ++p) {
+    float *row = data + p * stride;
+    std::copy(row, row + kNumOfGrids, plane.begin());
+    int index = 0;
+#ifdef __AVX2__
+    for (; index + 8 <= kNumOfGrids; index += 8) {
+      const __m256i source = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(table.data() + index));
+      _mm256_storeu_ps(row + index,
+                       _mm256_i32gather_ps(plane.data(), source, 4));
+    }
+#endif
+    for (; index < kNumOfGrids; ++index) row[index] = plane[table[index]];
+  }
+}
+
+}  // namespace
 
 std::vector<float> SlitherGame::transform_observation(
     const std::vector<float> &observation, int type) const {
   std::vector<float> data(observation);
   if (type != 0) {
-    int feature_num = (int)observation.size() / kNumOfGrids;
-    for (int i = 0; i < feature_num; i++) {
-      for (int index = 0; index < kNumOfGrids; index++) {
-        int new_index = transform_index(index, type);
-        data[i * kNumOfGrids + new_index] =
-            observation[i * kNumOfGrids + index];
-      }
-    }
+    gather_planes(data.data(), (int)data.size() / kNumOfGrids,
+                  kTransformTable[type]);
   }
   return data;
 }
@@ -1556,48 +1659,36 @@ std::vector<float> SlitherGame::transform_observation(
 std::vector<float> SlitherGame::transform_policy(
     const std::vector<float> &policy, int type) const {
   std::vector<float> data(policy);
-  if (type != 0) {
-    for (int index = 0; index < kNumOfGrids; index++) {
-      int new_index = transform_index(index, type);
-      data[new_index] = policy[index];
-    }
-  }
+  transform_policies(data.data(), 1, type);
   return data;
 }
 
 std::vector<float> SlitherGame::restore_policy(
     const std::vector<float> &policy, int type) const {
   std::vector<float> data(policy);
-  if (type != 0) {
-    for (int index = 0; index < kNumOfGrids; index++) {
-      int new_index = transform_index(index, type);
-      data[new_index] = policy[index];
-    }
-  }
+  restore_policies(data.data(), 1, type);
   return data;
 }
 
-int SlitherGame::transform_index(const int &index, const int type) const {
-  if (type == 0) {
-    return index;
-  } else {
-    int i = index / kBoardSize;
-    int j = index % kBoardSize;
-    if (type == 1) { // reflect horizontal
-      j = (kBoardSize - 1) - j;
-    }
-    else if (type == 2) { // reflect vertical
-      i = (kBoardSize - 1) - i;
-    }
-    else if (type == 3) { // reverse
-      i = (kBoardSize - 1) - i;
-      j = (kBoardSize - 1) - j;
-    }
-    return i * kBoardSize + j;
-  }
+void SlitherGame::transform_observations(float *observations, int batch,
+                                         int type) const {
+  if (type == 0) return;
+  gather_planes(observations, batch * kObservationPlanes,
+                kTransformTable[type]);
 }
 
+void SlitherGame::transform_policies(float *policies, int batch,
+                                     int type) const {
+  // the pass action (empty_index) is invariant under every symmetry
+  if (type == 0) return;
+  gather_planes(policies, batch, kTransformTable[type], kPolicyDim);
+}
 
+void SlitherGame::restore_policies(float *policies, int batch,
+                                   int type) const {
+  if (type == 0) return;
+  gather_planes(policies, batch, kRestoreTable[type], kPolicyDim);
+}
 
 std::string SlitherGame::action_to_string(
     const Action &action) const {
@@ -10,6 +10,42 @@ constexpr int kBoardSize = 5;
 constexpr int kNumOfGrids = kBoardSize * kBoardSize;
 constexpr int kPolicyDim = kNumOfGrids + 1;
 constexpr int empty_index = kNumOfGrids; // 25 in 5 * 5 board
+constexpr int kObservationPlanes = 4;
+
+/** Board symmetries
+ * 0 -> identity
+ * 1 -> reflect horizontal
+ * 2 -> reflect vertical
+ * 3 -> rotate 180 degrees */
+constexpr int kNumTransformations = 4;
+
+constexpr int transform_grid(const int index, const int type) {
+  int i = index / kBoardSize;
+  int j = index % kBoardSize;
+  if (type == 1 || type == 3) j = (kBoardSize - 1) - j;
+  if (type == 2 || type == 3) i = (kBoardSize - 1) - i;
+  return i * kBoardSize + j;
+}
+
+using TransformTable =
+    std::array<std::array<int, kNumOfGrids>, kNumTransformations>;
+
+/** table[type][index] is the grid read into `index`, so applying a
+ * symmetry is a single gather */
+constexpr TransformTable make_transform_table(const bool restore) {
+  TransformTable table{};
+  for (int type = 0; type < kNumTransformations; ++type) {
+    for (int index = 0; index < kNumOfGrids; ++index) {
+      const int new_index = transform_grid(index, type);
+      if (restore) table[type][index] = new_index;
+      else table[type][new_index] = index;
+    }
+  }
+  return table;
+}
+
+constexpr TransformTable kTransformTable = make_transform_table(false);
+constexpr TransformTable kRestoreTable = make_transform_table(true);
 
 /** Maximum number of steps */
 constexpr int kMaxTurn = INT16_MAX;
@@ -24,6 +60,9 @@ class SlitherState final : public State {
   SlitherState(const SlitherState &) = default;
   StatePtr clone() const override;
   void apply_action(const Action &) override;
+  bool supports_undo() const override { return true; }
+  void make_action(const Action &, UndoRecord &) override;
+  void undo_action(const UndoRecord &) override;
   void manual_action(const Action &, Player) override;
   bool test_action_bool(std::vector<Action>, std::vector<std::vector<Action>>&,Player) override;
   std::vector<std::vector<Action>> test_action(std::vector<Action>, std::vector<std::vector<Action>>&,Player) override;
@@ -31,8 +70,14 @@ class SlitherState final : public State {
   int test_generate(std::vector<Action>, int, int) override;
   std::vector<int> getboard() override;
   std::vector<std::vector<int>> get_critical(std::vector<std::vector<int>>);
+  /** get_critical(match_WP()), memoized by the black stones when the game
+   * cache is on, see SlitherGame::set_cache_entries; check_can_block and
+   * block_in_one are memoized by position_key */
+  std::vector<std::vector<int>> critical_points() override;
   // void generate_WP() override;
   bool check_can_block() override;
+  bool win_in_one() override;
+  bool block_in_one() override;
   // void store_TT(std::unordered_map<uint64_t, int> &, std::vector<int>, int) override;
   // bool lookup_TT(std::unordered_map<uint64_t, int> &, std::vector<int>) override;
 
@@ -40,7 +85,12 @@ class SlitherState final : public State {
   std::vector<std::vector<int>> match_WP();
   int DFS_noBlock(std::vector<int> &M, int cnt, int max, int num, std::vector<std::vector<int>>CPs, int&) override;
   std::vector<std::vector<int>> get_noBlock();
+  std::unique_ptr<BoardStream> stream_noBlock(std::vector<int> M, int cnt, std::vector<std::vector<int>> CPs) override;
+  std::unique_ptr<BoardStream> stream_generate(int cnt) override;
+  std::vector<PruneStats> prune_analysis(const std::vector<uint64_t>& boards, int threads, bool brute_force) override;
   bool check_diag(std::vector<int>, int);
+  // check_can_block without the cache
+  bool find_block();
   std::map<std::vector<int>, std::vector<int>> path_point;
   void generate_all(std::vector<std::vector<int>> &, std::vector<int> &, int , int);
   std::vector<std::vector<int>> generate(int cnt);
@@ -60,8 +110,20 @@ class SlitherState final : public State {
   //bool has_piece(const Player &) const;
   // std::unordered_map<uint64_t, int> TT;
   uint64_t convert_to_uint64_t(std::vector<int> M);
+  /** Exact key of everything legal_actions and apply_action read, so equal
+   * keys have equal move trees (winner aside) */
+  uint64_t position_key() const;
 
  private:
+  // times the private rule kernels, see clap/game/slither_benchmark.cc
+  friend class KernelBenchmark;
+  // bitboard one-turn search, see clap/game/slither/tactics.h
+  friend class Tactics;
+  // sets boards directly, as test_generate does
+  friend class CheckmateGenerator;
+  // likewise, to try white boards with the oracle
+  friend class PruneAnalysis;
+
   // whp
   bool check_redundent(std::vector<int> M, int num);
   bool check_win(std::vector<int> M, int color);
@@ -131,6 +193,10 @@ class SlitherGame final : public Game {
                                       int) const override;
   std::vector<float> restore_policy(const std::vector<float> &policy,
                                     int) const override;
+  void transform_observations(float *observations, int batch,
+                              int) const override;
+  void transform_policies(float *policies, int batch, int) const override;
+  void restore_policies(float *policies, int batch, int) const override;
 
   std::string action_to_string(const Action &action) const override;
   std::vector<Action> string_to_action(const std::string &str) const override;
@@ -138,10 +204,12 @@ class SlitherGame final : public Game {
 
   int getBoardSize() const override; 
   bool save_manual(const std::vector<Action> actions, const std::string savepath) const override;
+  // caches SlitherState::critical_points, check_can_block and block_in_one,
+  // shared by the threads of the process
+  void set_cache_entries(size_t entries) const override;
 
  private:
 //  StatePtr pre_state;
-  int transform_index(const int &index, int) const;
 };
 
 // *IMPORTANT* Register this game to the factory
@@ -0,0 +1,221 @@
+#include "clap/game/slither/tactics.h"
+
+#include <stdexcept>
+
+namespace clap::game::slither {
+namespace {
+
+using Bits = uint32_t;
+
+constexpr Bits kFull = (Bits{1} << kNumOfGrids) - 1;
+constexpr Bits kTopRow = (Bits{1} << kBoardSize) - 1;
+constexpr Bits kBottomRow = kTopRow << (kNumOfGrids - kBoardSize);
+constexpr Bits kLeftColumn = [] {
+  Bits column = 0;
+  for (int i = 0; i < kBoardSize; ++i) column |= Bits{1} << (i * kBoardSize);
+  return column;
+}();
+constexpr Bits kRightColumn = kLeftColumn << (kBoardSize - 1);
+
+Bits bit(int grid) { return grid < kNumOfGrids ? Bits{1} << grid : 0; }
+int first(Bits bits) { return __builtin_ctz(bits); }
+
+// up, down, left and right neighbours, the connections of have_win
+Bits cross(Bits bits) {
+  return ((bits >> kBoardSize) | (bits << kBoardSize) |
+          ((bits & ~kLeftColumn) >> 1) | ((bits & ~kRightColumn) << 1)) &
+         kFull;
+}
+
+// the eight neighbours of one cell, where a chosen piece may move
+Bits ring(Bits cell) {
+  const Bits row =
+      cell | ((cell & ~kLeftColumn) >> 1) | ((cell & ~kRightColumn) << 1);
+  return (row | (row >> kBoardSize) | (row << kBoardSize)) & kFull & ~cell;
+}
+
+// the cells of `stones` connected to `seeds`
+Bits flood(Bits stones, Bits seeds) {
+  Bits reached = seeds & stones;
+  for (Bits next; (next = (reached | cross(reached)) & stones) != reached;)
+    reached = next;
+  return reached;
+}
+
+// the sides a player connects: black top to bottom, white left to right
+struct Sides {
+  Bits head;
+  Bits tail;
+};
+
+Sides sides(Player player) {
+  if (player == 0) return {kTopRow, kBottomRow};
+  return {kLeftColumn, kRightColumn};
+}
+
+// fewest cells of `empty` that connect the sides through `stones`, capped at
+// limit + 1
+int distance(Bits stones, Bits empty, Sides sides, int limit) {
+  Bits reached = flood(stones, sides.head);
+  for (int cost = 0;; ++cost) {
+    if (reached & sides.tail) return cost;
+    if (cost == limit) return limit + 1;
+    const Bits step = (cross(reached) | sides.head) & empty & ~reached;
+    if (!step) return limit + 1;
+    reached = flood(stones | reached | step, reached | step);
+  }
+}
+
+// placements completing a connection through the placed or the moved piece,
+// the ones have_win checks
+Bits winning_places(Bits stones, Bits free, Bits moved, Sides sides) {
+  if (distance(stones, free, sides, 1) > 1) return 0;
+  Bits places = 0;
+  for (Bits rest = free; rest; rest &= rest - 1) {
+    const Bits place = rest & -rest;
+    const Bits component = flood(stones | place, place | moved);
+    if ((component & sides.head) && (component & sides.tail)) places |= place;
+  }
+  return places;
+}
+
+}  // namespace
+
+uint32_t Tactics::cells(const SlitherState& state, int piece) {
+  Bits bits = 0;
+  for (int i = 0; i < kNumOfGrids; ++i)
+    if (state.board_[i] == piece) bits |= bit(i);
+  return bits;
+}
+
+template <class Places, class Done>
+bool Tactics::search(SlitherState& state, Places&& places, Done&& done) {
+  const Player player = state.current_player();
+  const Bits own = cells(state, player);
+  const Bits empty = cells(state, SlitherState::EMPTY);
+  UndoRecord choose, move, place;
+
+  const auto play = [&](Bits candidates) {
+    for (; candidates; candidates &= candidates - 1) {
+      const int grid = first(candidates);
+      if (!state.is_legal_action(grid)) continue;
+      state.make_action(grid, place);
+      const bool found = done(state);
+      state.undo_action(place);
+      if (found) return true;
+    }
+    return false;
+  };
+
+  // turns that move a piece, choosing it only once a placement is left
+  for (Bits pieces = own; pieces; pieces &= pieces - 1) {
+    const int src = first(pieces);
+    bool chosen = false;
+    for (Bits dsts = ring(bit(src)) & empty; dsts; dsts &= dsts - 1) {
+      const int dst = first(dsts);
+      const Bits candidates = places(src, dst);
+      if (!candidates) continue;
+      if (!chosen) {
+        if (!state.is_legal_action(src)) break;
+        state.make_action(src, choose);
+        chosen = true;
+      }
+      if (!state.is_legal_action(dst)) continue;
+      state.make_action(dst, move);
+      const bool found = play(candidates);
+      state.undo_action(move);
+      if (found) {
+        state.undo_action(choose);
+        return true;
+      }
+    }
+    if (chosen) state.undo_action(choose);
+  }
+
+  // turns that only place, by choosing nothing or a piece that can not move;
+  // both leave the same state, so one way suffices
+  const Bits candidates = places(empty_index, empty_index);
+  if (!candidates) return false;
+  // legal_actions falls back to empty_index when nothing else is legal
+  const auto listed = [&] {
+    return state.legal_actions().back() == empty_index;
+  };
+  if (state.is_legal_action(empty_index) || listed()) {
+    state.make_action(empty_index, choose);
+    state.make_action(empty_index, move);
+  } else {
+    int src = -1;
+    for (Bits pieces = own; pieces && src == -1; pieces &= pieces - 1) {
+      const int grid = first(pieces);
+      if (!(ring(bit(grid)) & empty) || !state.is_legal_action(grid)) continue;
+      state.make_action(grid, choose);
+      if (listed()) src = grid;
+      else state.undo_action(choose);
+    }
+    if (src == -1) return false;
+    state.make_action(empty_index, move);
+  }
+  const bool found = play(candidates);
+  state.undo_action(move);
+  state.undo_action(choose);
+  return found;
+}
+
+bool Tactics::win_in_one(SlitherState& state) {
+  if (state.turn_ % 3 != 0)
+    throw std::invalid_argument("Tactics: a turn has already begun");
+  if (state.is_terminal()) return false;
+  const Player player = state.current_player();
+  const Sides goal = sides(player);
+  const Bits own = cells(state, player);
+  const Bits empty = cells(state, SlitherState::EMPTY);
+  // a turn adds two pieces at most
+  if (distance(own, empty, goal, 2) > 2) return false;
+
+  return search(
+      state,
+      [&](int src, int dst) {
+        const Bits moved = bit(dst);
+        return winning_places((own & ~bit(src)) | moved,
+                              (empty & ~moved) | bit(src), moved, goal);
+      },
+      [&](SlitherState& after) { return after.winner_ == player; });
+}
+
+bool Tactics::block_in_one(SlitherState& state) {
+  if (state.turn_ % 3 != 0)
+    throw std::invalid_argument("Tactics: a turn has already begun");
+  const Player player = state.current_player();
+  const Player opponent = 1 - player;
+  if (state.is_terminal()) return state.winner_ != opponent;
+  const Sides threat = sides(opponent);
+  const Bits other = cells(state, opponent);
+  const Bits empty = cells(state, SlitherState::EMPTY);
+
+  // placements after which the opponent is more than a turn from connecting
+  const auto safe = [&](int src, int dst) {
+    const Bits free = (empty & ~bit(dst)) | bit(src);
+    Bits places = 0;
+    for (Bits rest = free; rest; rest &= rest - 1) {
+      const Bits place = rest & -rest;
+      if (distance(other, free & ~place, threat, 2) > 2) places |= place;
+    }
+    return places;
+  };
+  // those need no search of the reply, so they go first
+  if (search(state, safe, [&](SlitherState& after) {
+        return after.winner_ != opponent;
+      }))
+    return true;
+  return search(
+      state,
+      [&](int src, int dst) {
+        return ((empty & ~bit(dst)) | bit(src)) & ~safe(src, dst);
+      },
+      [&](SlitherState& after) {
+        if (after.winner_ != -1) return after.winner_ == player;
+        return !win_in_one(after);
+      });
+}
+
+}  // namespace clap::game::slither
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+
+// One-turn tactics, exact under the rules of SlitherState. Whole turns are
+// enumerated on 25-bit boards first: flood fills rule out the (choose, move,
+// place) triples that can not decide the question, and only the rest are
+// played through the rule code, in place by make/unmake. Both take a state at
+// the start of a turn, and a placement always takes a cell of the board.
+class Tactics {
+ public:
+  // the side to move has a legal turn that ends in its win
+  static bool win_in_one(SlitherState& state);
+  // the side to move has a legal turn after which the opponent has no
+  // winning turn, e.g. white stopping every black threat
+  static bool block_in_one(SlitherState& state);
+
+ private:
+  // cells holding `piece`, bit i for grid i
+  static uint32_t cells(const SlitherState& state, int piece);
+  // plays the legal turns with a placement in places(src, dst), where
+  // empty_index stands for no piece moved, until done(state) holds
+  template <class Places, class Done>
+  static bool search(SlitherState& state, Places&& places, Done&& done);
+};
+
+}  // namespace clap::game::slither
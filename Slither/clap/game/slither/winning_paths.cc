@@ -0,0 +1,268 @@
+#include "clap/game/slither/winning_paths.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "clap/game/board_file.h"
+
+namespace clap::game::slither {
+namespace {
+
+using Cells = WinningPaths::Cells;
+
+// top-row sets deep enough to give every thread thousands of subtrees
+constexpr int kSplit = 6;
+
+bool test(const Cells& set, int cell) { return set[cell / 64] >> cell % 64 & 1; }
+void add(Cells& set, int cell) { set[cell / 64] |= uint64_t{1} << cell % 64; }
+
+bool empty(const Cells& set) {
+  return std::all_of(set.begin(), set.end(), [](uint64_t w) { return !w; });
+}
+
+int pop(Cells& set) {
+  int word = 0;
+  while (!set[word]) ++word;
+  const int cell = word * 64 + __builtin_ctzll(set[word]);
+  set[word] &= set[word] - 1;
+  return cell;
+}
+
+std::vector<int> cells(Cells set) {
+  std::vector<int> list;
+  while (!empty(set)) list.push_back(pop(set));
+  return list;
+}
+
+// by size, then lexicographically by their ascending cells
+void sort_paths(std::vector<std::pair<std::vector<int>, Cells>>& paths) {
+  std::sort(paths.begin(), paths.end(), [](const auto& a, const auto& b) {
+    return a.first.size() != b.first.size() ? a.first.size() < b.first.size()
+                                            : a.first < b.first;
+  });
+}
+
+// runs work(thread) on `threads` threads, this one among them
+template <class Work>
+void parallel(int threads, Work work) {
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; ++t) workers.emplace_back(work, t);
+  work(0);
+  for (auto& worker : workers) worker.join();
+}
+
+// the sets of a path index, each a walk from the root through ascending cells
+class SetTrie {
+ public:
+  void insert(const std::vector<int>& set) {
+    int node = 0;
+    for (const int cell : set) {
+      auto& children = nodes[node].children;
+      auto it = std::find_if(children.begin(), children.end(),
+                             [cell](const auto& c) { return c.first == cell; });
+      if (it != children.end()) {
+        node = it->second;
+        continue;
+      }
+      children.emplace_back(cell, nodes.size());
+      node = nodes.size();
+      nodes.emplace_back();
+    }
+    nodes[node].path = true;
+  }
+
+  // whether a set of the trie is a subset of `set`
+  bool subset_of(const Cells& set, int node = 0) const {
+    if (nodes[node].path) return true;
+    for (const auto& [cell, child] : nodes[node].children)
+      if (test(set, cell) && subset_of(set, child)) return true;
+    return false;
+  }
+
+ private:
+  struct Node {
+    std::vector<std::pair<int, int>> children;
+    bool path = false;
+  };
+  std::vector<Node> nodes{1};
+};
+
+}  // namespace
+
+WinningPaths::WinningPaths(const Options& options)
+    : options(options),
+      max_stones(options.max_stones > 0 ? options.max_stones
+                                        : options.size * options.size) {
+  if (options.size < 2 || options.size > kMaxSize)
+    throw std::invalid_argument("board size out of range");
+}
+
+std::vector<uint64_t> WinningPaths::run(Stats* stats) const {
+  const auto start = std::chrono::steady_clock::now();
+  const int n = options.size;
+  const int threads = std::max(1, options.threads);
+
+  // the shallow part of every root's tree here, its subtrees on the threads
+  std::vector<Frame> frames;
+  std::vector<Cells> candidates;
+  for (int root = 0; root < n; ++root) {
+    Frame frame{};
+    add(frame.untried, root);
+    for (int cell = 0; cell <= root; ++cell) add(frame.seen, cell);
+    grow(frame, kSplit, &frames, candidates);
+  }
+  std::vector<std::vector<Cells>> found(threads);
+  std::atomic<size_t> next{0};
+  parallel(threads, [&](int thread) {
+    for (size_t i = next++; i < frames.size(); i = next++)
+      grow(frames[i], kSplit, nullptr, found[thread]);
+  });
+  for (const auto& paths : found)
+    candidates.insert(candidates.end(), paths.begin(), paths.end());
+  const uint64_t count = candidates.size();
+
+  auto paths = minimal(std::move(candidates));
+  if (options.white) {
+    std::vector<std::pair<std::vector<int>, Cells>> sorted;
+    for (const auto& path : paths) {
+      const Cells set = transpose(path);
+      sorted.emplace_back(cells(set), set);
+    }
+    sort_paths(sorted);
+    for (size_t i = 0; i < paths.size(); ++i) paths[i] = sorted[i].second;
+  }
+
+  const uint32_t words = BoardFile::words(n * n);
+  std::vector<uint64_t> masks;
+  masks.reserve(paths.size() * words);
+  for (const auto& path : paths)
+    masks.insert(masks.end(), path.begin(), path.begin() + words);
+  if (stats) {
+    stats->candidates = count;
+    stats->paths = paths.size();
+    stats->seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  }
+  return masks;
+}
+
+// Redelmeier: each cell taken from untried joins the set once, and its
+// neighbours not yet seen become untried for the sets that contain it
+void WinningPaths::grow(const Frame& frame, int split,
+                        std::vector<Frame>* frames,
+                        std::vector<Cells>& paths) const {
+  const int n = options.size;
+  Cells untried = frame.untried;
+  while (!empty(untried)) {
+    const int cell = pop(untried);
+    Frame next = frame;
+    add(next.set, cell);
+    ++next.stones;
+    next.bottom = std::max(frame.bottom, cell / n);
+    if (next.bottom == n - 1 && diag(next.set) &&
+        (options.any_direction || sweep(next.set))) {
+      paths.push_back(next.set);
+      continue;
+    }
+    // every row still to go takes a stone
+    if (next.stones == max_stones ||
+        max_stones - next.stones < n - 1 - next.bottom)
+      continue;
+
+    next.untried = untried;
+    const int row = cell / n, col = cell % n;
+    for (const int neighbour :
+         {row > 0 ? cell - n : -1, row < n - 1 ? cell + n : -1,
+          col > 0 ? cell - 1 : -1, col < n - 1 ? cell + 1 : -1}) {
+      if (neighbour < 0 || test(next.seen, neighbour)) continue;
+      add(next.seen, neighbour);
+      add(next.untried, neighbour);
+    }
+    if (frames && next.stones == split) {
+      frames->push_back(next);
+    } else {
+      grow(next, split, frames, paths);
+    }
+  }
+}
+
+// check_diag: no two diagonal neighbours without a shared orthogonal one
+bool WinningPaths::diag(const Cells& set) const {
+  const int n = options.size;
+  for (const int cell : cells(set)) {
+    if (cell / n == n - 1) break;
+    const int below = cell + n;
+    if (test(set, below)) continue;
+    if (cell % n > 0 && test(set, below - 1) && !test(set, cell - 1))
+      return false;
+    if (cell % n < n - 1 && test(set, below + 1) && !test(set, cell + 1))
+      return false;
+  }
+  return true;
+}
+
+// the top row reaches the bottom one going down into a cell, then along its
+// row, and never up
+bool WinningPaths::sweep(const Cells& set) const {
+  const int n = options.size;
+  std::vector<char> reached(n);
+  for (int col = 0; col < n; ++col) reached[col] = test(set, col);
+  for (int row = 1; row < n; ++row) {
+    bool any = false;
+    for (int col = 0; col < n; ++col)
+      any |= reached[col] = reached[col] && test(set, row * n + col);
+    for (int col = 1; col < n; ++col)
+      reached[col] |= reached[col - 1] && test(set, row * n + col);
+    for (int col = n - 1; col-- > 0;)
+      reached[col] |= reached[col + 1] && test(set, row * n + col);
+    if (!any) return false;
+  }
+  return true;
+}
+
+// in the order of sort_paths; a candidate stays unless a smaller
+// path lies within it, so each size is checked in parallel against the trie
+// of the sizes before it
+std::vector<WinningPaths::Cells> WinningPaths::minimal(
+    std::vector<Cells> candidates) const {
+  std::vector<std::pair<std::vector<int>, Cells>> sorted;
+  sorted.reserve(candidates.size());
+  for (const auto& set : candidates) sorted.emplace_back(cells(set), set);
+  candidates = {};
+  sort_paths(sorted);
+
+  SetTrie trie;
+  std::vector<Cells> paths;
+  std::vector<char> keep(sorted.size());
+  for (size_t begin = 0, end; begin < sorted.size(); begin = end) {
+    for (end = begin; end < sorted.size() &&
+                      sorted[end].first.size() == sorted[begin].first.size();
+         ++end) {
+    }
+    std::atomic<size_t> next{begin};
+    parallel(std::max(1, options.threads), [&](int) {
+      for (size_t i = next++; i < end; i = next++)
+        keep[i] = !trie.subset_of(sorted[i].second);
+    });
+    for (size_t i = begin; i < end; ++i) {
+      if (!keep[i]) continue;
+      trie.insert(sorted[i].first);
+      paths.push_back(sorted[i].second);
+    }
+  }
+  return paths;
+}
+
+WinningPaths::Cells WinningPaths::transpose(const Cells& set) const {
+  const int n = options.size;
+  Cells transposed{};
+  for (const int cell : cells(set)) add(transposed, cell % n * n + cell / n);
+  return transposed;
+}
+
+}  // namespace clap::game::slither
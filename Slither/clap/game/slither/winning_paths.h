@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace clap::game::slither {
+
+// The minimal winning paths of an N x N board, as winning_path/N.txt holds
+// them for 5 x 5: the cell sets that connect the top row to the bottom one
+// and pass the diagonal rule of check_diag, leaving out those that contain a
+// smaller one. A path connects as the sweep winning_path/ was made with does,
+// row by row downwards and sideways within a row, or with any_direction
+// through any orthogonal neighbours as have_win does. White's paths, left to
+// right, are black's transposed.
+//
+// The connected sets are enumerated with Redelmeier's algorithm from each
+// top-row cell as their smallest, a set ending its growth once it is a path;
+// the subtrees below a fixed depth are shared out between threads. Supersets
+// are then dropped size by size against a trie of the paths kept so far.
+class WinningPaths {
+ public:
+  static constexpr int kMaxSize = 16;
+  using Cells = std::array<uint64_t, kMaxSize * kMaxSize / 64>;
+
+  struct Options {
+    int size = 5;
+    // the largest path, all of them when 0
+    int max_stones = 0;
+    int threads = 1;
+    bool white = false;
+    bool any_direction = false;
+  };
+
+  struct Stats {
+    // paths before the supersets are dropped
+    uint64_t candidates = 0;
+    uint64_t paths = 0;
+    double seconds = 0.0;
+  };
+
+  explicit WinningPaths(const Options& options);
+
+  // the paths by size, equal sizes in lexicographic order of their ascending
+  // cells; each BoardFile::words(size * size) words
+  std::vector<uint64_t> run(Stats* stats = nullptr) const;
+
+ private:
+  struct Frame {
+    Cells set, untried, seen;
+    int stones;
+    int bottom;  // lowest row reached
+  };
+
+  void grow(const Frame& frame, int split, std::vector<Frame>* frames,
+            std::vector<Cells>& paths) const;
+  bool diag(const Cells& set) const;
+  bool sweep(const Cells& set) const;
+  std::vector<Cells> minimal(std::vector<Cells> candidates) const;
+  Cells transpose(const Cells& set) const;
+
+  const Options options;
+  const int max_stones;
+};
+
+}  // namespace clap::game::slither
@@ -0,0 +1,697 @@
+// Micro-benchmark of the Slither rule kernels.
+//
+// Times every kernel over position sets taken from checkmate/checkmate_N.txt
+// (black stones of a position per line) and from self-play SGF records, and
+// prints ns per call with a checksum of the results as JSON. Given a baseline
+// written by an earlier run, it reports the speedup of every kernel and fails
+// on slowdowns past the tolerance or on changed results.
+//
+//   slither_benchmark --data . --checkmate 4,5,6 --positions 256
+//       --output after.json --baseline before.json
+//
+// --checkmate takes the stone counts N of the checkmate_N.txt sets. match_WP
+// reads ./winning_path/, so the benchmark works from the data dir. The
+// searches test_action_bool and block_in_one take tens of microseconds a call
+// on mid-game positions, the other kernels well under ten; narrow long runs
+// with --kernels and --positions.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "clap/game/game.h"
+#include "clap/game/slither/batch_rules.h"
+#include "clap/game/slither/combinations.h"
+#include "clap/game/slither/slither.h"
+#include "clap/game/slither/tactics.h"
+
+namespace clap::game::slither {
+
+struct Sample {
+  uint64_t ops = 0;
+  // FNV-1a over the results
+  uint64_t checksum = 0xcbf29ce484222325ULL;
+  std::chrono::nanoseconds time{0};
+};
+
+using Positions = std::vector<SlitherState>;
+
+template <class F>
+std::chrono::nanoseconds timed(F&& f) {
+  const auto begin = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::steady_clock::now() - begin;
+}
+
+inline void mix(uint64_t& checksum, uint64_t value) {
+  checksum = (checksum ^ value) * 0x100000001b3ULL;
+}
+
+// Every kernel prepares its inputs outside the timed region and returns the
+// time of one pass over the positions.
+class KernelBenchmark {
+ public:
+  static Sample legal_actions(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (const auto& state : positions) {
+        for (const Action action : state.legal_actions())
+          mix(sample.checksum, action);
+      }
+    });
+    sample.ops = positions.size();
+    return sample;
+  }
+
+  // every legal action of the choose, move and place phase of the first
+  // legal move, each on its own copy
+  static Sample apply_action(Positions& positions) {
+    std::vector<SlitherState> states;
+    std::vector<Action> actions;
+    for (const auto& position : positions) {
+      SlitherState state = position;
+      for (int phase = 0; phase < 3 && !state.is_terminal(); ++phase) {
+        const auto legal = state.legal_actions();
+        for (const Action action : legal) {
+          states.push_back(state);
+          actions.push_back(action);
+        }
+        state.apply_action(legal.front());
+      }
+    }
+    Sample sample;
+    sample.time = timed([&] {
+      for (size_t i = 0; i < states.size(); ++i)
+        states[i].apply_action(actions[i]);
+    });
+    for (const auto& state : states) {
+      mix(sample.checksum, state.turn_);
+      mix(sample.checksum, state.winner_ + 1);
+    }
+    sample.ops = states.size();
+    return sample;
+  }
+
+  static Sample clone(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (const auto& state : positions)
+        mix(sample.checksum, state.clone()->current_player());
+    });
+    sample.ops = positions.size();
+    return sample;
+  }
+
+  // from every stone
+  static Sample have_win(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (const auto& state : positions) {
+        for (int i = 0; i < kNumOfGrids; ++i) {
+          if (state.board_[i] == SlitherState::EMPTY) continue;
+          mix(sample.checksum, state.have_win(i));
+          ++sample.ops;
+        }
+      }
+    });
+    return sample;
+  }
+
+  // every step of the player to move, and every placement
+  static Sample get_restrictions(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (const auto& state : positions) {
+        const Player player = state.current_player();
+        for (int src = 0; src < kNumOfGrids; ++src) {
+          if (state.board_[src] == SlitherState::EMPTY) {
+            mix(sample.checksum,
+                state.get_restrictions(empty_index, src, player).size());
+            ++sample.ops;
+            continue;
+          }
+          if (state.board_[src] != player) continue;
+          for (const int direction : MoveDirection) {
+            const int dst = src + direction;
+            if (dst < 0 || dst >= kNumOfGrids ||
+                std::abs(dst % kBoardSize - src % kBoardSize) > 1 ||
+                state.board_[dst] != SlitherState::EMPTY)
+              continue;
+            mix(sample.checksum,
+                state.get_restrictions(src, dst, player).size());
+            ++sample.ops;
+          }
+        }
+      }
+    });
+    return sample;
+  }
+
+  // every stone of the player to move, and the pass
+  static Sample is_selecting_valid(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (const auto& state : positions) {
+        const Player player = state.current_player();
+        for (int i = 0; i <= kNumOfGrids; ++i) {
+          if (i != kNumOfGrids && state.board_[i] != player) continue;
+          mix(sample.checksum, state.is_selecting_valid(i, player));
+          ++sample.ops;
+        }
+      }
+    });
+    return sample;
+  }
+
+  static Sample check_can_block(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (auto& state : positions)
+        mix(sample.checksum, state.check_can_block());
+    });
+    sample.ops = positions.size();
+    return sample;
+  }
+
+  static Sample match_WP(Positions& positions) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (auto& state : positions) {
+        for (const auto& path : state.match_WP()) {
+          for (const int point : path) mix(sample.checksum, point);
+          mix(sample.checksum, kNumOfGrids);
+        }
+      }
+    });
+    sample.ops = positions.size();
+    return sample;
+  }
+
+  static Sample get_critical(Positions& positions) {
+    std::vector<std::vector<std::vector<int>>> paths;
+    for (auto& state : positions) paths.push_back(state.match_WP());
+    Sample sample;
+    sample.time = timed([&] {
+      for (size_t i = 0; i < positions.size(); ++i) {
+        for (const auto& critical : positions[i].get_critical(paths[i])) {
+          for (const int point : critical) mix(sample.checksum, point);
+          mix(sample.checksum, kNumOfGrids);
+        }
+      }
+    });
+    sample.ops = positions.size();
+    return sample;
+  }
+
+  // the white boards test_prune tries, the rules a batch at a time (see
+  // clap/game/slither/batch_rules.h); ops are candidate boards
+  static Sample stream_noBlock(Positions& positions) {
+    std::vector<std::vector<std::vector<int>>> critical;
+    Sample sample;
+    for (auto& state : positions) {
+      critical.push_back(state.critical_points());
+      const uint32_t black =
+          BatchRules::mask(state.getboard(), SlitherState::BLACK);
+      sample.ops += Combinations(~black & ((1u << kNumOfGrids) - 1),
+                                 __builtin_popcount(black))
+                        .size();
+    }
+    sample.time = timed([&] {
+      for (size_t i = 0; i < positions.size(); ++i) {
+        const auto M = positions[i].getboard();
+        const int stones = std::count(M.begin(), M.end(), SlitherState::BLACK);
+        auto stream = positions[i].stream_noBlock(M, stones, critical[i]);
+        int64_t kept = 0;
+        for (auto batch = stream->next_batch(4096); !batch.empty();
+             batch = stream->next_batch(4096))
+          kept += batch.size();
+        mix(sample.checksum, kept);
+        mix(sample.checksum, stream->valid());
+      }
+    });
+    return sample;
+  }
+
+  // can black win with its next move, as test_board asks it
+  static Sample test_action_bool(Positions& positions) {
+    Positions states = positions;
+    Sample sample;
+    sample.time = timed([&] {
+      for (auto& state : states) {
+        std::vector<std::vector<Action>> paths;
+        mix(sample.checksum,
+            state.test_action_bool({}, paths, SlitherState::BLACK));
+      }
+    });
+    sample.ops = positions.size();
+    return sample;
+  }
+
+  // the one-turn oracle of clap/game/slither/tactics.h, on turn starts
+  static Sample win_in_one(Positions& positions) {
+    return tactics(positions, Tactics::win_in_one);
+  }
+
+  static Sample block_in_one(Positions& positions) {
+    return tactics(positions, Tactics::block_in_one);
+  }
+
+  static Sample tactics(Positions& positions, bool (*oracle)(SlitherState&)) {
+    Sample sample;
+    sample.time = timed([&] {
+      for (auto& state : positions) {
+        if (phase(state) != 0) continue;
+        mix(sample.checksum, oracle(state));
+        ++sample.ops;
+      }
+    });
+    return sample;
+  }
+
+  // 0 choose, 1 move, 2 place
+  static int phase(const SlitherState& state) { return state.turn_ % 3; }
+
+  // black stones as CLI_agent.py test_prune places them
+  static SlitherState from_black_stones(const SlitherState& initial,
+                                        const std::vector<Action>& stones) {
+    SlitherState state = initial;
+    for (const Action stone : stones) {
+      state.manual_action(empty_index, SlitherState::BLACK);
+      state.manual_action(empty_index, SlitherState::BLACK);
+      state.manual_action(stone, SlitherState::BLACK);
+    }
+    return state;
+  }
+};
+
+namespace {
+
+using Kernel = std::function<Sample(Positions&)>;
+
+const std::vector<std::pair<std::string, Kernel>> kKernels = {
+    {"legal_actions", KernelBenchmark::legal_actions},
+    {"apply_action", KernelBenchmark::apply_action},
+    {"clone", KernelBenchmark::clone},
+    {"have_win", KernelBenchmark::have_win},
+    {"get_restrictions", KernelBenchmark::get_restrictions},
+    {"is_selecting_valid", KernelBenchmark::is_selecting_valid},
+    {"check_can_block", KernelBenchmark::check_can_block},
+    {"match_WP", KernelBenchmark::match_WP},
+    {"get_critical", KernelBenchmark::get_critical},
+    {"stream_noBlock", KernelBenchmark::stream_noBlock},
+    {"test_action_bool", KernelBenchmark::test_action_bool},
+    {"win_in_one", KernelBenchmark::win_in_one},
+    {"block_in_one", KernelBenchmark::block_in_one},
+};
+
+struct Options {
+  std::string data = ".";
+  std::vector<int> checkmate = {4, 5, 6, 7, 8};
+  // relative to the data dir
+  std::vector<std::string> sgf = {"automode_save", "autosave.sgf"};
+  std::vector<std::string> kernels;
+  int positions = 256;
+  double min_time = 0.2;
+  double tolerance = 0.1;
+  std::string output;
+  std::string baseline;
+};
+
+struct Result {
+  std::string set;
+  std::string kernel;
+  int positions;
+  uint64_t ops;
+  double ns_per_op;
+  uint64_t checksum;
+};
+
+std::vector<std::string> split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    if (!item.empty()) items.push_back(item);
+  return items;
+}
+
+SlitherState initial_state() {
+  const auto state = load("slither")->new_initial_state();
+  return static_cast<const SlitherState&>(*state);
+}
+
+// at most `limit` evenly spaced positions, so every size of set costs alike
+Positions load_checkmate(const std::string& path, size_t limit) {
+  std::ifstream file(path);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);)
+    if (line.find_first_not_of(' ') != std::string::npos) lines.push_back(line);
+
+  const SlitherState initial = initial_state();
+  Positions positions;
+  const size_t stride = std::max<size_t>(1, lines.size() / limit);
+  for (size_t i = 0; i < lines.size() && positions.size() < limit;
+       i += stride) {
+    std::stringstream ss(lines[i]);
+    std::vector<Action> stones;
+    for (Action stone; ss >> stone;) stones.push_back(stone);
+    positions.push_back(KernelBenchmark::from_black_stones(initial, stones));
+  }
+  return positions;
+}
+
+// "AB" as written by SlitherGame::save_manual
+Action sgf_point(char column, char row) {
+  const int c = column - 'A';
+  const int r = kBoardSize - 1 - (row - 'A');
+  if (c < 0 || c >= kBoardSize || r < 0 || r >= kBoardSize) return empty_index;
+  return r * kBoardSize + c;
+}
+
+// Replays every game of a record, one "(;GM[511];W[..]...)" per game, and
+// keeps the position before every move.
+void load_sgf(const std::string& path, const SlitherState& initial,
+              Positions& positions) {
+  std::ifstream file(path);
+  const std::string text((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  SlitherState state = initial;
+  const auto play = [&](Action action) {
+    const auto legal = state.legal_actions();
+    if (state.is_terminal() ||
+        std::find(legal.begin(), legal.end(), action) == legal.end())
+      return false;
+    state.apply_action(action);
+    return true;
+  };
+
+  bool valid = false;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '(') {
+      state = initial;
+      valid = true;
+      continue;
+    }
+    if (text[i] != ';' || i + 2 >= text.size() ||
+        (text[i + 1] != 'B' && text[i + 1] != 'W') || text[i + 2] != '[')
+      continue;
+    const size_t end = text.find(']', i);
+    if (end == std::string::npos) break;
+    const std::string move = text.substr(i + 3, end - i - 3);
+    i = end;
+    if (!valid || state.is_terminal()) continue;
+
+    const SlitherState before = state;
+    if (move.size() == 4) {
+      // "srcdst", its placement is the next property
+      valid = play(sgf_point(move[0], move[1])) &&
+              play(sgf_point(move[2], move[3]));
+      if (valid) positions.push_back(before);
+    } else if (move.size() == 2) {
+      // the placement of a move, or a lone placement skipping it
+      if (KernelBenchmark::phase(state) == 0) {
+        valid = play(empty_index) && play(empty_index);
+        if (valid) positions.push_back(before);
+      }
+      valid = valid && play(sgf_point(move[0], move[1]));
+    } else {
+      valid = false;
+    }
+  }
+}
+
+std::vector<std::pair<std::string, Positions>> load_sets(
+    const Options& options) {
+  std::vector<std::pair<std::string, Positions>> sets;
+  for (const int size : options.checkmate) {
+    const std::string name = "checkmate_" + std::to_string(size);
+    auto positions = load_checkmate("checkmate/" + name + ".txt",
+                                    options.positions);
+    if (!positions.empty()) sets.emplace_back(name, std::move(positions));
+  }
+
+  namespace fs = std::filesystem;
+  std::vector<std::string> files;
+  for (const auto& path : options.sgf) {
+    if (fs::is_directory(path)) {
+      for (const auto& entry : fs::directory_iterator(path))
+        if (entry.path().extension() == ".sgf") files.push_back(entry.path());
+    } else if (fs::exists(path)) {
+      files.push_back(path);
+    }
+  }
+  std::sort(files.begin(), files.end());
+  const SlitherState initial = initial_state();
+  Positions positions;
+  for (const auto& file : files) load_sgf(file, initial, positions);
+  const size_t wanted = options.positions;
+  if (positions.size() > wanted) {
+    Positions sampled;
+    const size_t stride = positions.size() / wanted;
+    for (size_t i = 0; sampled.size() < wanted; i += stride)
+      sampled.push_back(positions[i]);
+    positions = std::move(sampled);
+  }
+  if (!positions.empty()) sets.emplace_back("sgf", std::move(positions));
+  return sets;
+}
+
+// Repeats whole passes until min_time and keeps the fastest, which is the
+// least disturbed by the rest of the machine. The checksum is of the first.
+Result measure(const std::string& set, Positions& positions,
+               const std::string& name, const Kernel& kernel,
+               double min_time) {
+  const auto budget = std::chrono::duration<double>(min_time);
+  Result result{set, name, static_cast<int>(positions.size()), 0, 0.0, 0};
+  std::chrono::nanoseconds elapsed{0};
+  do {
+    const Sample sample = kernel(positions);
+    if (sample.ops == 0) break;
+    const double ns_per_op =
+        static_cast<double>(sample.time.count()) / sample.ops;
+    if (result.ops == 0) {
+      result.ns_per_op = ns_per_op;
+      result.checksum = sample.checksum;
+    }
+    result.ns_per_op = std::min(result.ns_per_op, ns_per_op);
+    result.ops += sample.ops;
+    elapsed += sample.time;
+  } while (elapsed < budget);
+  return result;
+}
+
+std::string hex(uint64_t value) {
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << value;
+  return ss.str();
+}
+
+// value of "key" in a line written by write_json
+std::string field(const std::string& line, const std::string& key) {
+  const std::string tag = "\"" + key + "\": ";
+  const size_t begin = line.find(tag);
+  if (begin == std::string::npos) return "";
+  std::string value =
+      line.substr(begin + tag.size(),
+                  line.find_first_of(",}", begin + tag.size()) - begin -
+                      tag.size());
+  value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+  return value;
+}
+
+// (set, kernel) -> result of an earlier run
+std::map<std::pair<std::string, std::string>, Result> read_baseline(
+    const std::string& path) {
+  std::map<std::pair<std::string, std::string>, Result> baseline;
+  std::ifstream file(path);
+  if (!file) throw std::runtime_error("cannot open " + path);
+  for (std::string line; std::getline(file, line);) {
+    if (field(line, "kernel").empty()) continue;
+    Result result;
+    result.set = field(line, "set");
+    result.kernel = field(line, "kernel");
+    result.positions = std::stoi(field(line, "positions"));
+    result.ops = std::stoull(field(line, "ops"));
+    result.ns_per_op = std::stod(field(line, "ns_per_op"));
+    result.checksum = std::stoull(field(line, "checksum"), nullptr, 16);
+    baseline[{result.set, result.kernel}] = result;
+  }
+  return baseline;
+}
+
+void write_json(std::ostream& out, const Options& options,
+                const std::vector<Result>& results) {
+  out << "{\n  \"positions\": " << options.positions
+      << ",\n  \"min_time\": " << options.min_time << ",\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"set\": \"" << r.set
+        << "\", \"kernel\": \"" << r.kernel
+        << "\", \"positions\": " << r.positions << ", \"ops\": " << r.ops
+        << ", \"ns_per_op\": " << r.ns_per_op << ", \"checksum\": \""
+        << hex(r.checksum) << "\"}";
+  }
+  out << "\n  ]\n}" << std::endl;
+}
+
+// returns false on a slowdown past the tolerance, a changed checksum or when
+// no result is in the baseline
+bool compare(
+    const std::vector<Result>& results,
+    const std::map<std::pair<std::string, std::string>, Result>& baseline,
+    double tolerance) {
+  bool ok = true;
+  int compared = 0;
+  for (const auto& r : results) {
+    const auto it = baseline.find({r.set, r.kernel});
+    if (it == baseline.end()) continue;
+    ++compared;
+    const auto& b = it->second;
+    std::cerr << std::left << std::setw(14) << r.set << std::setw(20)
+              << r.kernel << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << r.ns_per_op << " ns (baseline "
+              << b.ns_per_op << ", x" << std::setprecision(2)
+              << (r.ns_per_op > 0 ? b.ns_per_op / r.ns_per_op : 0.0) << ")";
+    if (b.positions != r.positions) {
+      std::cerr << " positions differ, not compared" << std::endl;
+      continue;
+    }
+    if (b.checksum != r.checksum) {
+      std::cerr << " CHECKSUM MISMATCH";
+      ok = false;
+    }
+    if (r.ns_per_op > b.ns_per_op * (1 + tolerance)) {
+      std::cerr << " REGRESSION";
+      ok = false;
+    }
+    std::cerr << std::endl;
+  }
+  if (compared == 0) {
+    std::cerr << "no set and kernel of this run is in the baseline"
+              << std::endl;
+    return false;
+  }
+  return ok;
+}
+
+constexpr char kUsage[] =
+    "usage: slither_benchmark [--data DIR] [--checkmate N,...]\n"
+    "           [--sgf FILE,...] [--kernels NAME,...] [--positions N]\n"
+    "           [--min-time SECONDS]\n"
+    "           [--output FILE] [--baseline FILE] [--tolerance FRACTION]\n"
+    "--checkmate takes stone counts, the N of DIR/checkmate/checkmate_N.txt";
+
+[[noreturn]] void usage(const std::string& error) {
+  if (!error.empty()) std::cerr << error << "\n";
+  std::cerr << kUsage << std::endl;
+  std::exit(error.empty() ? 0 : 1);
+}
+
+Options parse(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") usage("");
+    if (i + 1 == argc) usage("missing value of " + key);
+    const std::string value = argv[++i];
+    // std::stoi and std::stod throw invalid_argument or out_of_range
+    try {
+      if (key == "--data") {
+        options.data = value;
+      } else if (key == "--checkmate") {
+        options.checkmate.clear();
+        for (const auto& size : split(value))
+          options.checkmate.push_back(std::stoi(size));
+      } else if (key == "--sgf") {
+        options.sgf = split(value);
+      } else if (key == "--kernels") {
+        options.kernels = split(value);
+      } else if (key == "--positions") {
+        options.positions = std::max(1, std::stoi(value));
+      } else if (key == "--min-time") {
+        options.min_time = std::stod(value);
+      } else if (key == "--tolerance") {
+        options.tolerance = std::stod(value);
+      } else if (key == "--output") {
+        options.output = value;
+      } else if (key == "--baseline") {
+        options.baseline = value;
+      } else {
+        usage("unknown option " + key);
+      }
+    } catch (const std::logic_error&) {
+      usage("bad value of " + key + ": " + value);
+    }
+  }
+  for (const auto& name : options.kernels) {
+    if (std::none_of(kKernels.begin(), kKernels.end(),
+                     [&](const auto& kernel) { return kernel.first == name; }))
+      usage("unknown kernel " + name);
+  }
+  // output & baseline stay relative to where we were started
+  namespace fs = std::filesystem;
+  if (!options.output.empty()) options.output = fs::absolute(options.output);
+  if (!options.baseline.empty())
+    options.baseline = fs::absolute(options.baseline);
+  return options;
+}
+
+}  // namespace
+}  // namespace clap::game::slither
+
+int main(int argc, char* argv[]) try {
+  using namespace clap::game::slither;  // NOLINT
+  const auto options = parse(argc, argv);
+  // before the run, so a bad baseline does not cost one
+  std::map<std::pair<std::string, std::string>, Result> baseline;
+  if (!options.baseline.empty()) baseline = read_baseline(options.baseline);
+  std::filesystem::current_path(options.data);
+
+  auto sets = load_sets(options);
+  if (sets.empty()) {
+    std::cerr << "no positions found under " << options.data << std::endl;
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (auto& [set, positions] : sets) {
+    for (const auto& [name, kernel] : kKernels) {
+      if (!options.kernels.empty() &&
+          std::find(options.kernels.begin(), options.kernels.end(), name) ==
+              options.kernels.end())
+        continue;
+      results.push_back(
+          measure(set, positions, name, kernel, options.min_time));
+      const auto& r = results.back();
+      std::cerr << r.set << " " << r.kernel << ": " << r.ns_per_op
+                << " ns/op over " << r.ops << " ops" << std::endl;
+    }
+  }
+
+  if (options.output.empty()) {
+    write_json(std::cout, options, results);
+  } else {
+    std::ofstream file(options.output);
+    write_json(file, options, results);
+  }
+  if (!options.baseline.empty() &&
+      !compare(results, baseline, options.tolerance))
+    return 1;
+  return 0;
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
@@ -0,0 +1,105 @@
+// Converts the text boards of winning_path/ and checkmate/ (one board per
+// line as ascending cell numbers) to a mapped BoardFile, and back.
+//
+//   slither_boards --output winning_path/winning_path.bin
+//       winning_path/5.txt winning_path/6.txt ... winning_path/11.txt
+//   slither_boards --index --output checkmate/checkmate_8.bin
+//       checkmate/checkmate_8.txt
+//   slither_boards --dump checkmate/checkmate_8.bin
+//
+// The inputs are concatenated in the order given. --index adds the sorted
+// index BoardFile::find searches; --cells sets the board size (25 cells).
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "clap/game/board_file.h"
+#include "clap/game/slither/slither.h"
+
+namespace clap::game {
+namespace {
+
+struct Options {
+  std::vector<std::string> inputs;
+  std::string output;
+  std::string dump;
+  uint32_t cells = slither::kNumOfGrids;
+  bool index = false;
+};
+
+constexpr char kUsage[] =
+    "usage: slither_boards [--index] [--cells N] --output FILE TEXT...\n"
+    "       slither_boards --dump FILE";
+
+[[noreturn]] void usage(const std::string& error) {
+  if (!error.empty()) std::cerr << error << "\n";
+  std::cerr << kUsage << std::endl;
+  std::exit(error.empty() ? 0 : 1);
+}
+
+Options parse(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") usage("");
+    if (key == "--index") {
+      options.index = true;
+      continue;
+    }
+    if (key.rfind("--", 0) != 0) {
+      options.inputs.push_back(key);
+      continue;
+    }
+    if (key != "--output" && key != "--dump" && key != "--cells")
+      usage("unknown option " + key);
+    if (i + 1 == argc) usage("missing value of " + key);
+    const std::string value = argv[++i];
+    if (key == "--output") {
+      options.output = value;
+    } else if (key == "--dump") {
+      options.dump = value;
+    } else {
+      options.cells = std::stoul(value);
+    }
+  }
+  if (options.dump.empty() &&
+      (options.output.empty() || options.inputs.empty()))
+    usage("missing --output or inputs");
+  return options;
+}
+
+}  // namespace
+}  // namespace clap::game
+
+int main(int argc, char* argv[]) try {
+  using clap::game::BoardFile;
+  const auto options = clap::game::parse(argc, argv);
+
+  if (!options.dump.empty()) {
+    const BoardFile file(options.dump);
+    const uint32_t words = file.words();
+    for (uint64_t row = 0; row < file.size(); ++row) {
+      const uint64_t* mask = file.masks() + row * words;
+      for (uint32_t word = 0; word < words; ++word)
+        for (uint64_t board = mask[word]; board; board &= board - 1)
+          std::cout << word * 64 + __builtin_ctzll(board) << " ";
+      std::cout << "\n";
+    }
+    return 0;
+  }
+
+  std::vector<uint64_t> masks;
+  for (const auto& input : options.inputs) {
+    const auto boards = BoardFile::read_text(input);
+    masks.insert(masks.end(), boards.begin(), boards.end());
+  }
+  BoardFile::write(options.output, options.cells, masks, options.index);
+  std::cout << masks.size() << " boards in " << options.output << std::endl;
+  return 0;
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
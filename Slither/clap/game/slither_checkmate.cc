@@ -0,0 +1,144 @@
+// Parallel, resumable generator of checkmate/checkmate_N.txt.
+//
+// Finds the boards SlitherState::test_generate lists, on --threads threads,
+// into binary shards under --shards (checkmate/checkmate_N.shards by
+// default). A killed run started again with the same --stones and --chunk
+// goes on after the last complete chunk. Once every chunk is done the shards
+// are merged into --output, which must be given, sorted and without
+// duplicates; --symmetric keeps one board per class of the board symmetries.
+// --merge-only merges what the shards hold so far. An --output ending in .bin
+// is a BoardFile with its sorted index instead of text.
+//
+//   slither_checkmate --stones 8 --threads 32
+//       --output checkmate/checkmate_8.txt
+//
+// The win in one turn is found by Tactics::win_in_one, or by the brute force
+// test_action_bool of test_generate with --brute-force.
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "clap/game/board_file.h"
+#include "clap/game/game.h"
+#include "clap/game/slither/checkmate.h"
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+namespace {
+
+struct Options {
+  CheckmateGenerator::Options generator{
+      6, static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))};
+  std::string shards;
+  std::string output;
+  bool symmetric = false;
+  bool merge_only = false;
+};
+
+constexpr char kUsage[] =
+    "usage: slither_checkmate --output FILE [--stones K] [--threads T]\n"
+    "           [--chunk RANKS] [--shards DIR] [--symmetric] [--merge-only]\n"
+    "           [--brute-force]";
+
+[[noreturn]] void usage(const std::string& error) {
+  if (!error.empty()) std::cerr << error << "\n";
+  std::cerr << kUsage << std::endl;
+  std::exit(error.empty() ? 0 : 1);
+}
+
+Options parse(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") usage("");
+    if (key == "--symmetric") {
+      options.symmetric = true;
+      continue;
+    }
+    if (key == "--merge-only") {
+      options.merge_only = true;
+      continue;
+    }
+    if (key == "--brute-force") {
+      options.generator.oracle = false;
+      continue;
+    }
+    if (key != "--stones" && key != "--threads" && key != "--chunk" &&
+        key != "--shards" && key != "--output")
+      usage("unknown option " + key);
+    if (i + 1 == argc) usage("missing value of " + key);
+    const std::string value = argv[++i];
+    if (key == "--stones") {
+      options.generator.stones = std::stoi(value);
+    } else if (key == "--threads") {
+      options.generator.threads = std::max(1, std::stoi(value));
+    } else if (key == "--chunk") {
+      options.generator.chunk_size = std::stoull(value);
+    } else if (key == "--shards") {
+      options.shards = value;
+    } else {
+      options.output = value;
+    }
+  }
+  // the text databases are tracked, so none is written unless named
+  if (options.output.empty()) usage("missing --output");
+  if (options.shards.empty())
+    options.shards = "checkmate/checkmate_" +
+                     std::to_string(options.generator.stones) + ".shards";
+  return options;
+}
+
+}  // namespace
+}  // namespace clap::game::slither
+
+int main(int argc, char* argv[]) try {
+  using clap::game::BoardFile;
+  using namespace clap::game::slither;  // NOLINT
+  const auto options = parse(argc, argv);
+  const auto initial = clap::game::load("slither")->new_initial_state();
+  CheckmateGenerator generator(static_cast<const SlitherState&>(*initial),
+                               options.generator);
+
+  bool complete = true;
+  if (!options.merge_only) {
+    auto run = std::async(std::launch::async,
+                          [&] { return generator.run(options.shards); });
+    while (run.wait_for(std::chrono::seconds(10)) !=
+           std::future_status::ready) {
+      std::cerr << "chunks " << generator.done() << " / " << generator.chunks()
+                << std::endl;
+    }
+    const auto stats = run.get();
+    std::cout << options.generator.stones << " stones: " << stats.chunks
+              << " chunks (" << stats.resumed << " from an earlier run), "
+              << "this run " << stats.boards << " boards, "
+              << stats.checkmates << " checkmates, " << std::fixed
+              << std::setprecision(1) << stats.seconds << "s" << std::endl;
+    complete = generator.done() == generator.chunks();
+  }
+  if (!complete) return 1;
+
+  const auto boards =
+      CheckmateGenerator::merge(options.shards, options.symmetric);
+  const std::string bin = ".bin";
+  if (options.output.size() > bin.size() &&
+      options.output.compare(options.output.size() - bin.size(), bin.size(),
+                             bin) == 0) {
+    BoardFile::write(options.output, kNumOfGrids,
+                     std::vector<uint64_t>(boards.begin(), boards.end()),
+                     true);
+  } else {
+    CheckmateGenerator::write_text(options.output, boards);
+  }
+  std::cout << boards.size() << " boards in " << options.output << std::endl;
+  return 0;
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
@@ -0,0 +1,99 @@
+// Generator of the minimal winning paths of an N x N board, the paths of
+// winning_path/ for any size and either colour.
+//
+//   slither_paths --size 5 --max-stones 11
+//       --output winning_path/winning_path.bin
+//   slither_paths --size 9 --color white --max-stones 12 --threads 32
+//       --output winning_path/winning_path_9_white.bin
+//
+// The output is a BoardFile of size * size cells holding the paths by size,
+// equal sizes in lexicographic order. --max-stones bounds the paths; without
+// it every path is found, which takes long beyond 5 x 5. With --max-stones
+// 11, 5 x 5 black gives what slither_boards makes of winning_path/5.txt ...
+// 11.txt, the 189 paths winning_paths() loads; without it 6 more paths of 12
+// and 13 stones follow them, and winning_paths() would load those as well.
+// --any-direction lets a path turn back upwards, as have_win does, where the
+// paths of winning_path/ only go down and sideways.
+
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "clap/game/board_file.h"
+#include "clap/game/slither/winning_paths.h"
+
+namespace clap::game::slither {
+namespace {
+
+struct Options {
+  WinningPaths::Options paths{
+      5, 0, static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))};
+  std::string output;
+};
+
+constexpr char kUsage[] =
+    "usage: slither_paths --output FILE [--size N] [--color black|white]\n"
+    "           [--max-stones K] [--any-direction] [--threads T]";
+
+[[noreturn]] void usage(const std::string& error) {
+  if (!error.empty()) std::cerr << error << "\n";
+  std::cerr << kUsage << std::endl;
+  std::exit(error.empty() ? 0 : 1);
+}
+
+Options parse(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") usage("");
+    if (key == "--any-direction") {
+      options.paths.any_direction = true;
+      continue;
+    }
+    if (key != "--size" && key != "--color" && key != "--max-stones" &&
+        key != "--threads" && key != "--output")
+      usage("unknown option " + key);
+    if (i + 1 == argc) usage("missing value of " + key);
+    const std::string value = argv[++i];
+    if (key == "--size") {
+      options.paths.size = std::stoi(value);
+    } else if (key == "--color") {
+      if (value != "black" && value != "white")
+        usage("unknown color " + value);
+      options.paths.white = value == "white";
+    } else if (key == "--max-stones") {
+      options.paths.max_stones = std::stoi(value);
+    } else if (key == "--threads") {
+      options.paths.threads = std::max(1, std::stoi(value));
+    } else {
+      options.output = value;
+    }
+  }
+  if (options.output.empty()) usage("missing --output");
+  return options;
+}
+
+}  // namespace
+}  // namespace clap::game::slither
+
+int main(int argc, char* argv[]) try {
+  using clap::game::BoardFile;
+  using namespace clap::game::slither;  // NOLINT
+  const auto options = parse(argc, argv);
+
+  const int size = options.paths.size;
+  WinningPaths::Stats stats;
+  const auto masks = WinningPaths(options.paths).run(&stats);
+  BoardFile::write(options.output, size * size, masks, false);
+  std::cout << size << "x" << size << ": " << stats.candidates
+            << " candidates, " << stats.paths << " minimal paths in "
+            << options.output << ", " << std::fixed << std::setprecision(1)
+            << stats.seconds << "s" << std::endl;
+  return 0;
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
@@ -0,0 +1,232 @@
+// Perft for the Slither move generators.
+//
+// Counts the leaves of the move tree at every depth up to --depth for each
+// position, with every registered generator (or the ones in --generators),
+// and fails if any two disagree. Only legal_actions is registered so far, so
+// the cross-checks that apply are those of --verify: it adds a single
+// threaded run without the cache and by plain copies, which guards the
+// parallel split and the table, and with --make-unmake, which walks the tree
+// in place, SlitherState::undo_action against the copies.
+//
+//   slither_perft --depth 6 --threads 8 --checkmate checkmate/checkmate_6.txt
+//       --limit 4 --divide
+//
+// Positions are the initial one by default, or one per line of --positions
+// (actions as State::serialize writes them) or of --checkmate (black stones
+// as in checkmate/checkmate_N.txt).
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "clap/game/game.h"
+#include "clap/game/slither/perft.h"
+#include "clap/game/slither/slither.h"
+
+namespace clap::game::slither {
+namespace {
+
+struct Options {
+  int depth = 4;
+  int threads = std::max(1U, std::thread::hardware_concurrency());
+  size_t cache_mb = 64;
+  std::vector<std::string> generators;
+  std::string positions;
+  std::string checkmate;
+  int limit = 16;
+  bool divide = false;
+  bool verify = false;
+  bool make_unmake = false;
+};
+
+std::vector<std::string> split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    if (!item.empty()) items.push_back(item);
+  return items;
+}
+
+std::vector<SlitherState> load_positions(const Options& options) {
+  const auto game = load("slither");
+  const auto initial = game->new_initial_state();
+  std::vector<SlitherState> positions;
+  const std::string& path =
+      options.checkmate.empty() ? options.positions : options.checkmate;
+  if (path.empty()) {
+    positions.push_back(static_cast<const SlitherState&>(*initial));
+    return positions;
+  }
+
+  std::ifstream file(path);
+  if (!file) throw std::runtime_error("cannot open " + path);
+  std::string line;
+  while (positions.size() < static_cast<size_t>(options.limit) &&
+         std::getline(file, line)) {
+    std::stringstream ss(line);
+    SlitherState state = static_cast<const SlitherState&>(*initial);
+    for (Action action; ss >> action;) {
+      if (options.checkmate.empty()) {
+        state.apply_action(action);
+        continue;
+      }
+      // as CLI_agent.py test_prune places the black stones
+      state.manual_action(empty_index, 0);
+      state.manual_action(empty_index, 0);
+      state.manual_action(action, 0);
+    }
+    positions.push_back(state);
+  }
+  return positions;
+}
+
+// prints the root actions whose counts differ, returns whether all agree
+bool same(const Perft::Result& a, const Perft::Result& b) {
+  if (a.nodes == b.nodes && a.divide == b.divide) return true;
+  std::map<Action, std::pair<uint64_t, uint64_t>> actions;
+  for (const auto& [action, nodes] : a.divide) actions[action].first = nodes;
+  for (const auto& [action, nodes] : b.divide) actions[action].second = nodes;
+  for (const auto& [action, nodes] : actions) {
+    if (nodes.first == nodes.second) continue;
+    std::cerr << "  action " << action << ": " << nodes.first << " vs "
+              << nodes.second << std::endl;
+  }
+  return false;
+}
+
+void report(int position, int depth, const std::string& name,
+            const Perft::Result& result, bool divide) {
+  std::cout << "position " << position << " depth " << depth << " " << name
+            << ": " << result.nodes << " nodes, " << std::fixed
+            << std::setprecision(3) << result.seconds << "s, "
+            << std::setprecision(0)
+            << (result.seconds > 0 ? result.nodes / result.seconds : 0.0)
+            << " nodes/s, " << result.cache_hits << " cache hits"
+            << std::endl;
+  if (!divide) return;
+  for (const auto& [action, nodes] : result.divide)
+    std::cout << "  " << action << ": " << nodes << std::endl;
+}
+
+constexpr char kUsage[] =
+    "usage: slither_perft [--depth N] [--threads T] [--cache-mb MB]\n"
+    "           [--generators NAME,...] [--positions FILE | --checkmate FILE]\n"
+    "           [--limit N] [--divide] [--verify] [--make-unmake]";
+
+[[noreturn]] void usage(const std::string& error) {
+  if (!error.empty()) std::cerr << error << "\n";
+  std::cerr << kUsage << std::endl;
+  std::exit(error.empty() ? 0 : 1);
+}
+
+Options parse(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") usage("");
+    if (key == "--divide") {
+      options.divide = true;
+      continue;
+    }
+    if (key == "--verify") {
+      options.verify = true;
+      continue;
+    }
+    if (key == "--make-unmake") {
+      options.make_unmake = true;
+      continue;
+    }
+    if (key != "--depth" && key != "--threads" && key != "--cache-mb" &&
+        key != "--generators" && key != "--positions" &&
+        key != "--checkmate" && key != "--limit")
+      usage("unknown option " + key);
+    if (i + 1 == argc) usage("missing value of " + key);
+    const std::string value = argv[++i];
+    // std::stoi and std::stoul throw invalid_argument or out_of_range
+    try {
+      if (key == "--depth") {
+        options.depth = std::stoi(value);
+      } else if (key == "--threads") {
+        options.threads = std::max(1, std::stoi(value));
+      } else if (key == "--cache-mb") {
+        options.cache_mb = std::stoul(value);
+      } else if (key == "--generators") {
+        options.generators = split(value);
+      } else if (key == "--positions") {
+        options.positions = value;
+      } else if (key == "--checkmate") {
+        options.checkmate = value;
+      } else {
+        options.limit = std::stoi(value);
+      }
+    } catch (const std::logic_error&) {
+      usage("bad value of " + key + ": " + value);
+    }
+  }
+  const auto known = Perft::generators();
+  for (const auto& name : options.generators) {
+    if (std::find(known.begin(), known.end(), name) == known.end())
+      usage("unknown generator " + name);
+  }
+  if (options.generators.empty()) options.generators = known;
+  return options;
+}
+
+}  // namespace
+}  // namespace clap::game::slither
+
+int main(int argc, char* argv[]) try {
+  using namespace clap::game::slither;  // NOLINT
+  const auto options = parse(argc, argv);
+  const auto positions = load_positions(options);
+  if (positions.empty()) {
+    std::cerr << "no positions to count" << std::endl;
+    return 1;
+  }
+  const size_t cache_entries =
+      (options.cache_mb << 20) / (2 * sizeof(uint64_t));
+
+  bool ok = true;
+  for (size_t p = 0; p < positions.size(); ++p) {
+    // one table per generator, kept over the depths of a position
+    std::vector<Perft> perfts;
+    for (const auto& name : options.generators)
+      perfts.emplace_back(Perft::generator(name), options.threads,
+                          cache_entries, options.make_unmake);
+    for (int depth = 1; depth <= options.depth; ++depth) {
+      std::vector<Perft::Result> results;
+      for (size_t g = 0; g < perfts.size(); ++g) {
+        results.push_back(perfts[g].run(positions[p], depth));
+        report(p, depth, options.generators[g], results.back(),
+               options.divide);
+      }
+      if (options.verify) {
+        Perft reference(Perft::generator(options.generators.front()), 1, 0);
+        results.push_back(reference.run(positions[p], depth));
+        report(p, depth, options.generators.front() + " (serial)",
+               results.back(), false);
+      }
+      for (size_t r = 1; r < results.size(); ++r) {
+        if (same(results.front(), results[r])) continue;
+        std::cerr << "MISMATCH at position " << p << " depth " << depth
+                  << std::endl;
+        ok = false;
+      }
+    }
+  }
+  return ok ? 0 : 1;
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
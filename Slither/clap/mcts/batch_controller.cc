@@ -0,0 +1,120 @@
+#include "clap/mcts/batch_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace clap::mcts {
+
+void BatchController::reset(int max_batch_size,
+                            std::chrono::microseconds max_wait,
+                            int num_workers) {
+  std::lock_guard<std::mutex> lock(mutex);
+  this->max_batch_size = std::max(max_batch_size, 1);
+  this->max_wait = max_wait;
+  this->num_workers = std::max(num_workers, 1);
+  arrivals = 0;
+  forwarded = 0;
+  offered_load = 0.0;
+  batch_cutoff = this->max_batch_size;
+  wait = max_wait;
+  latency_us.assign(this->max_batch_size + 1, 0.0);
+  samples.assign(this->max_batch_size + 1, 0);
+  histogram.assign(kHistogramBuckets, 0);
+}
+
+void BatchController::record_arrival(int count) {
+  arrivals.fetch_add(count, std::memory_order_relaxed);
+}
+
+void BatchController::record_forward(int batch_size, Clock::duration latency) {
+  const double us =
+      std::chrono::duration<double, std::micro>(latency).count();
+  const int bucket = std::clamp(
+      static_cast<int>(std::log2(us + 1.0)), 0, kHistogramBuckets - 1);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ++histogram[bucket];
+  forwarded += batch_size;
+  batch_size = std::clamp(batch_size, 1, max_batch_size);
+  auto& mean = latency_us[batch_size];
+  mean = samples[batch_size]++ == 0 ? us
+                                    : mean + kSmoothing * (us - mean);
+}
+
+BatchController::LatencyFit BatchController::fit_latency() const {
+  // least squares over the observed sizes
+  double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (int b = 1; b <= max_batch_size; ++b) {
+    if (samples[b] == 0) continue;
+    n += 1;
+    sx += b;
+    sy += latency_us[b];
+    sxx += static_cast<double>(b) * b;
+    sxy += b * latency_us[b];
+  }
+  LatencyFit fit;
+  if (n == 0) return fit;
+  fit.known = true;
+  const double denominator = n * sxx - sx * sx;
+  if (n == 1 || denominator == 0) {
+    fit.intercept = sy / n;
+    return fit;
+  }
+  fit.slope = std::max((n * sxy - sx * sy) / denominator, 0.0);
+  fit.intercept = (sy - fit.slope * sx) / n;
+  return fit;
+}
+
+double BatchController::estimate_latency(int batch_size,
+                                         const LatencyFit& fit) const {
+  if (samples[batch_size] > 0) return latency_us[batch_size];
+  if (!fit.known) return -1.0;
+  return std::max(fit.intercept + fit.slope * batch_size, 1.0);
+}
+
+std::tuple<int, std::chrono::microseconds> BatchController::plan() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // in a closed loop the jobs come back at the rate batches finish, so the
+  // rate says nothing about how many there are; count the ones outstanding
+  const int64_t outstanding = std::max<int64_t>(
+      arrivals.load(std::memory_order_relaxed) - forwarded, 0);
+  offered_load = offered_load == 0.0
+                     ? outstanding
+                     : offered_load + kSmoothing * (outstanding - offered_load);
+
+  // nothing known yet, keep the configured limits
+  if (offered_load <= 0.0) {
+    batch_cutoff = max_batch_size;
+    wait = max_wait;
+    return {batch_cutoff, wait};
+  }
+
+  // each worker takes its share of the load, so no batch waits on jobs the
+  // others hold
+  batch_cutoff = std::clamp(
+      static_cast<int>(std::ceil(offered_load / num_workers)), 1,
+      max_batch_size);
+
+  // wait for the rest of the share no longer than a forward pass of it takes,
+  // after which running the part collected is the better use of the model
+  const double latency = estimate_latency(batch_cutoff, fit_latency());
+  wait = latency < 0 ? max_wait
+                     : std::min(max_wait,
+                                std::chrono::microseconds(static_cast<int64_t>(
+                                    std::ceil(latency))));
+  return {batch_cutoff, wait};
+}
+
+BatchController::Stats BatchController::stats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  Stats stats;
+  stats.batch_cutoff = batch_cutoff;
+  stats.wait_us = wait.count();
+  stats.offered_load = offered_load;
+  stats.mean_latency_us = latency_us;
+  stats.latency_histogram = histogram;
+  return stats;
+}
+
+}  // namespace clap::mcts
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace clap::mcts {
+
+// Picks the inference batch cut-off and wait deadline online from the
+// offered load, the jobs waiting for or in inference, and the forward latency
+// of each batch size.
+class BatchController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats {
+    int batch_cutoff;
+    int64_t wait_us;
+    // jobs waiting for or in inference
+    double offered_load;
+    // mean_latency_us[batch size], 0 if never observed
+    std::vector<double> mean_latency_us;
+    // latency_histogram[i] counts forward passes in [2^i, 2^(i+1)) us
+    std::vector<uint64_t> latency_histogram;
+  };
+
+  BatchController() = default;
+
+  void reset(int max_batch_size, std::chrono::microseconds max_wait,
+             int num_workers = 1);
+  void record_arrival(int count = 1);
+  void record_forward(int batch_size, Clock::duration latency);
+  // batch cut-off, wait deadline
+  std::tuple<int, std::chrono::microseconds> plan();
+  Stats stats();
+
+  ~BatchController() = default;
+
+  static constexpr int kHistogramBuckets = 32;
+  // EWMA weight of a new sample
+  static constexpr double kSmoothing = 0.2;
+
+ private:
+  // latency = intercept + slope * batch size over the observed sizes
+  struct LatencyFit {
+    bool known = false;
+    double intercept = 0.0;
+    double slope = 0.0;
+  };
+  LatencyFit fit_latency() const;
+  // the observed mean of a size, the fit for the others; -1 if none known
+  double estimate_latency(int batch_size, const LatencyFit& fit) const;
+
+  std::mutex mutex;
+  std::atomic<int64_t> arrivals{0};
+  // jobs of the forwarded batches
+  int64_t forwarded = 0;
+
+  int max_batch_size = 1;
+  int num_workers = 1;
+  std::chrono::microseconds max_wait{0};
+
+  double offered_load = 0.0;
+  int batch_cutoff = 1;
+  std::chrono::microseconds wait{0};
+
+  // latency_us[b] / samples[b] for batch size b
+  std::vector<double> latency_us;
+  std::vector<int64_t> samples;
+  std::vector<uint64_t> histogram;
+};
+
+}  // namespace clap::mcts
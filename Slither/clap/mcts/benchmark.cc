@@ -0,0 +1,305 @@
+// Model-free MCTS throughput benchmark.
+//
+// Runs Engine, SlitherEngine, VLEngine and SlitherVLEngine with the stub
+// evaluator (uniform policy, zero value, optional fixed forward latency) over a
+// sweep of cpu workers, batch sizes and virtual losses, and writes simulations
+// per second and scaling efficiency as JSON.
+//
+//   mcts_benchmark --games slither --workers 1,2,4,8 --batch-sizes 8,32
+//       --virtual-loss 1,3 --seconds 3 --output bench.json
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "clap/game/game.h"
+#include "clap/game/slither/slither.h"
+#include "clap/mcts/engine.h"
+#include "clap/mcts/engine_stats.h"
+#include "clap/mcts/vl/engine.h"
+
+namespace clap::mcts {
+namespace {
+
+struct Options {
+  std::vector<std::string> games;
+  std::vector<std::string> engines = {"Engine", "SlitherEngine", "VLEngine",
+                                      "SlitherVLEngine"};
+  std::vector<int> workers;
+  std::vector<int> batch_sizes = {8, 32};
+  std::vector<int> virtual_losses = {1, 3};
+  int gpu_workers = 1;
+  int latency_us = 0;
+  int max_simulations = 400;
+  double warmup_seconds = 0.5;
+  double seconds = 2.0;
+  std::string output;
+};
+
+struct Result {
+  std::string engine;
+  std::string game;
+  int cpu_workers;
+  int batch_size;
+  int virtual_loss;
+  uint64_t simulations;
+  double simulations_per_second;
+  double mean_batch;
+  double scaling_efficiency;
+};
+
+std::vector<std::string> split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    if (!item.empty()) items.push_back(item);
+  return items;
+}
+
+std::vector<int> split_int(const std::string& list) {
+  std::vector<int> values;
+  for (const auto& item : split(list)) values.push_back(std::stoi(item));
+  return values;
+}
+
+template <class EngineT>
+Result run(const Options& options, const std::string& name,
+           const std::string& game, int cpu_workers, int batch_size,
+           int virtual_loss) {
+  EngineT::batch_size = batch_size;
+  EngineT::max_simulations = options.max_simulations;
+  EngineT::c_puct = 1.5;
+  EngineT::dirichlet_alpha = 0.0;
+  EngineT::dirichlet_epsilon = 0.0;
+  EngineT::stub_inference = true;
+  EngineT::stub_latency_us = options.latency_us;
+  EngineT::verbose = false;
+  EngineT::dump_tree = false;
+  EngineT::play_until_terminal = true;
+  EngineT::auto_reset_job = true;
+  constexpr bool is_vl = std::is_base_of_v<vl::EngineConfig, EngineT>;
+  if constexpr (is_vl) EngineT::virtual_loss = virtual_loss;
+
+  auto engine = std::make_unique<EngineT>(std::vector<int>{-1});
+  engine->load_game(game);
+  engine->start(cpu_workers, options.gpu_workers);
+
+  // finished games pile up in the trajectory queue, keep it drained
+  const auto run_for = [&](double seconds) {
+    const auto end = std::chrono::steady_clock::now() +
+                     std::chrono::duration<double>(seconds);
+    std::string raw;
+    while (std::chrono::steady_clock::now() < end) {
+      while (engine->trajectories.try_dequeue(raw)) continue;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  };
+  run_for(options.warmup_seconds);
+  const auto begin = engine->stats.snapshot();
+  const auto begin_time = std::chrono::steady_clock::now();
+  run_for(options.seconds);
+  const auto end = engine->stats.snapshot();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - begin_time;
+  engine->stop();
+
+  const auto delta = [&](EngineStats::Counter counter) {
+    return end[counter] - begin[counter];
+  };
+  Result result{};
+  result.engine = name;
+  result.game = game;
+  result.cpu_workers = cpu_workers;
+  result.batch_size = batch_size;
+  result.virtual_loss = is_vl ? virtual_loss : 0;
+  result.simulations = delta(EngineStats::kSimulations);
+  result.simulations_per_second = result.simulations / elapsed.count();
+  result.mean_batch =
+      delta(EngineStats::kBatches) > 0
+          ? static_cast<double>(delta(EngineStats::kBatchedJobs)) /
+                delta(EngineStats::kBatches)
+          : 0.0;
+  return result;
+}
+
+// per-worker throughput relative to the smallest worker count of the same
+// engine, game, batch size and virtual loss
+void compute_scaling(std::vector<Result>& results) {
+  std::map<std::tuple<std::string, std::string, int, int>, const Result*> base;
+  for (const auto& result : results) {
+    auto& best = base[{result.engine, result.game, result.batch_size,
+                       result.virtual_loss}];
+    if (best == nullptr || result.cpu_workers < best->cpu_workers)
+      best = &result;
+  }
+  for (auto& result : results) {
+    const auto* best = base[{result.engine, result.game, result.batch_size,
+                             result.virtual_loss}];
+    const double base_rate =
+        best->simulations_per_second / best->cpu_workers;
+    result.scaling_efficiency =
+        base_rate > 0
+            ? result.simulations_per_second / result.cpu_workers / base_rate
+            : 0.0;
+  }
+}
+
+void write_json(std::ostream& out, const Options& options,
+                const std::vector<Result>& results) {
+  out << "{\n  \"hardware_concurrency\": "
+      << std::thread::hardware_concurrency()
+      << ",\n  \"gpu_workers\": " << options.gpu_workers
+      << ",\n  \"latency_us\": " << options.latency_us
+      << ",\n  \"seconds\": " << options.seconds << ",\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"engine\": \"" << r.engine
+        << "\", \"game\": \"" << r.game
+        << "\", \"cpu_workers\": " << r.cpu_workers
+        << ", \"batch_size\": " << r.batch_size
+        << ", \"virtual_loss\": " << r.virtual_loss
+        << ", \"simulations\": " << r.simulations
+        << ", \"simulations_per_second\": " << r.simulations_per_second
+        << ", \"mean_batch\": " << r.mean_batch
+        << ", \"scaling_efficiency\": " << r.scaling_efficiency << "}";
+  }
+  out << "\n  ]\n}" << std::endl;
+}
+
+constexpr char kUsage[] =
+    "usage: mcts_benchmark [--games G,...] [--engines E,...]\n"
+    "           [--workers N,...] [--batch-sizes N,...]\n"
+    "           [--virtual-loss N,...] [--gpu-workers N] [--latency-us N]\n"
+    "           [--max-simulations N]\n"
+    "           [--warmup SECONDS] [--seconds SECONDS] [--output FILE]\n"
+    "engines: Engine, SlitherEngine, VLEngine, SlitherVLEngine";
+
+[[noreturn]] void usage(const std::string& error) {
+  if (!error.empty()) std::cerr << error << "\n";
+  std::cerr << kUsage << std::endl;
+  std::exit(error.empty() ? 0 : 1);
+}
+
+Options parse(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") usage("");
+    if (i + 1 == argc) usage("missing value of " + key);
+    const std::string value = argv[++i];
+    // std::stoi and std::stod throw invalid_argument or out_of_range
+    try {
+      if (key == "--games") {
+        options.games = split(value);
+      } else if (key == "--engines") {
+        options.engines = split(value);
+      } else if (key == "--workers") {
+        options.workers = split_int(value);
+      } else if (key == "--batch-sizes") {
+        options.batch_sizes = split_int(value);
+      } else if (key == "--virtual-loss") {
+        options.virtual_losses = split_int(value);
+      } else if (key == "--gpu-workers") {
+        options.gpu_workers = std::stoi(value);
+      } else if (key == "--latency-us") {
+        options.latency_us = std::stoi(value);
+      } else if (key == "--max-simulations") {
+        options.max_simulations = std::stoi(value);
+      } else if (key == "--warmup") {
+        options.warmup_seconds = std::stod(value);
+      } else if (key == "--seconds") {
+        options.seconds = std::stod(value);
+      } else if (key == "--output") {
+        options.output = value;
+      } else {
+        usage("unknown option " + key);
+      }
+    } catch (const std::logic_error&) {
+      usage("bad value of " + key + ": " + value);
+    }
+  }
+  for (const auto& engine : options.engines) {
+    if (engine != "Engine" && engine != "SlitherEngine" &&
+        engine != "VLEngine" && engine != "SlitherVLEngine")
+      usage("unknown engine " + engine);
+  }
+  if (options.games.empty()) {
+    const auto games = game::list();
+    const bool has_slither =
+        std::find(games.begin(), games.end(), "slither") != games.end();
+    options.games = {has_slither ? "slither" : games.front()};
+  }
+  if (options.workers.empty()) {
+    for (unsigned w = 1;
+         w <= std::max(1U, std::thread::hardware_concurrency()); w *= 2)
+      options.workers.push_back(w);
+  }
+  return options;
+}
+
+}  // namespace
+}  // namespace clap::mcts
+
+int main(int argc, char* argv[]) {
+  using namespace clap::mcts;  // NOLINT
+  const auto options = parse(argc, argv);
+
+  std::vector<Result> results;
+  for (const auto& game : options.games) {
+    for (const auto& engine : options.engines) {
+      const bool vl = engine == "VLEngine" || engine == "SlitherVLEngine";
+      const bool slither = engine == "SlitherEngine" ||
+                           engine == "SlitherVLEngine";
+      // the slither engines only run slither
+      if (slither && game != "slither") continue;
+      // virtual loss only matters to the VL engines
+      const auto virtual_losses =
+          vl ? options.virtual_losses : std::vector<int>{0};
+      for (const int batch_size : options.batch_sizes) {
+        for (const int virtual_loss : virtual_losses) {
+          for (const int workers : options.workers) {
+            if (vl && slither) {
+              results.push_back(run<vl::SlitherEngine>(
+                  options, engine, game, workers, batch_size, virtual_loss));
+            } else if (vl) {
+              results.push_back(run<vl::Engine>(options, engine, game, workers,
+                                                batch_size, virtual_loss));
+            } else if (slither) {
+              results.push_back(run<SlitherEngine>(options, engine, game,
+                                                   workers, batch_size, 0));
+            } else {
+              results.push_back(
+                  run<Engine>(options, engine, game, workers, batch_size, 0));
+            }
+            const auto& r = results.back();
+            std::cerr << r.engine << " " << r.game << " workers "
+                      << r.cpu_workers << " batch " << r.batch_size
+                      << " vl " << r.virtual_loss << ": "
+                      << r.simulations_per_second << " sims/s" << std::endl;
+          }
+        }
+      }
+    }
+  }
+  compute_scaling(results);
+
+  if (options.output.empty()) {
+    write_json(std::cout, options, results);
+  } else {
+    std::ofstream file(options.output);
+    write_json(file, options, results);
+  }
+  return 0;
+}
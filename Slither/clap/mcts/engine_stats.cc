@@ -0,0 +1,166 @@
+#include "clap/mcts/engine_stats.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace clap::mcts {
+
+EngineStats::Snapshot EngineStats::snapshot() const {
+  Snapshot total{};
+  blocks.for_each([&](const Block& block) {
+    for (int i = 0; i < kNumCounters; ++i)
+      total[i] += block.counters[i].load(std::memory_order_relaxed);
+  });
+  return total;
+}
+
+void EngineStats::reset() {
+  blocks.for_each([](Block& block) {
+    for (auto& counter : block.counters)
+      counter.store(0, std::memory_order_relaxed);
+  });
+}
+
+const char* EngineStats::name(Counter counter) {
+  switch (counter) {
+    case kSimulations:
+      return "simulations";
+    case kExpansions:
+      return "expansions";
+    case kTTProbes:
+      return "tt_probes";
+    case kTTHits:
+      return "tt_hits";
+    case kLabelsResolved:
+      return "labels_resolved";
+    case kQueueWaits:
+      return "queue_waits";
+    case kQueueWaitUs:
+      return "queue_wait_us";
+    case kBatches:
+      return "batches";
+    case kBatchedJobs:
+      return "batched_jobs";
+    default:
+      return "unknown";
+  }
+}
+
+std::string EngineStats::format(const Snapshot& now, const Snapshot& previous,
+                                std::chrono::duration<double> elapsed) {
+  const auto delta = [&](Counter counter) {
+    return static_cast<double>(now[counter] - previous[counter]);
+  };
+  const auto ratio = [](double a, double b) { return b > 0 ? a / b : 0.0; };
+  const double seconds = elapsed.count();
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1)
+     << "simulations " << now[kSimulations] << " ("
+     << ratio(delta(kSimulations), seconds) << "/s)"
+     << ", expansions " << now[kExpansions]
+     << ", tt hit " << 100 * ratio(delta(kTTHits), delta(kTTProbes)) << "%"
+     << ", labels " << now[kLabelsResolved]
+     << ", batch " << ratio(delta(kBatchedJobs), delta(kBatches))
+     << ", queue wait "
+     << ratio(delta(kQueueWaitUs), delta(kQueueWaits)) << "us";
+  return ss.str();
+}
+
+PhaseHistograms::Summary PhaseHistograms::summary(Phase phase) const {
+  std::vector<uint64_t> counts(kNumBuckets);
+  blocks.for_each([&](const Block& block) {
+    for (int i = 0; i < kNumBuckets; ++i)
+      counts[i] += block.buckets[phase][i].load(std::memory_order_relaxed);
+  });
+
+  Summary summary{};
+  double sum = 0.0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    if (counts[i] == 0) continue;
+    const uint64_t value = lower_bound(i);
+    if (summary.count == 0) summary.min = value;
+    summary.max = value;
+    summary.count += counts[i];
+    sum += static_cast<double>(value) * counts[i];
+    summary.buckets.emplace_back(value, counts[i]);
+  }
+  if (summary.count == 0) return summary;
+  summary.mean = sum / summary.count;
+
+  constexpr std::array<double, 4> kQuantiles = {0.5, 0.9, 0.99, 0.999};
+  uint64_t seen = 0;
+  size_t q = 0;
+  for (const auto& [value, count] : summary.buckets) {
+    seen += count;
+    while (q < kQuantiles.size() && seen >= kQuantiles[q] * summary.count)
+      summary.percentiles[q++] = value;
+  }
+  return summary;
+}
+
+void PhaseHistograms::reset() {
+  blocks.for_each([](Block& block) {
+    for (auto& phase : block.buckets) {
+      for (auto& bucket : phase) bucket.store(0, std::memory_order_relaxed);
+    }
+  });
+}
+
+const char* PhaseHistograms::name(Phase phase) {
+  switch (phase) {
+    case kSelectDepth:
+      return "select_depth";
+    case kSelectNs:
+      return "select_ns";
+    case kInferenceQueueNs:
+      return "inference_queue_ns";
+    case kBatchAssemblyNs:
+      return "batch_assembly_ns";
+    case kForwardNs:
+      return "forward_ns";
+    case kUpdateNs:
+      return "update_ns";
+    case kCheckCanBlockNs:
+      return "check_can_block_ns";
+    case kWaitExpandNs:
+      return "wait_expand_ns";
+    default:
+      return "unknown";
+  }
+}
+
+void StatsReporter::start(const EngineStats& stats,
+                          std::chrono::milliseconds interval) {
+  std::lock_guard lock(mutex);
+  if (running) return;
+  running = true;
+  thread = std::thread(&StatsReporter::run, this, std::cref(stats), interval);
+}
+
+void StatsReporter::stop() {
+  {
+    std::lock_guard lock(mutex);
+    if (!running) return;
+    running = false;
+  }
+  stopped.notify_all();
+  thread.join();
+}
+
+void StatsReporter::run(const EngineStats& stats,
+                        std::chrono::milliseconds interval) {
+  auto previous = stats.snapshot();
+  auto last = std::chrono::steady_clock::now();
+  std::unique_lock lock(mutex);
+  while (!stopped.wait_for(lock, interval, [this] { return !running; })) {
+    const auto now = stats.snapshot();
+    const auto time = std::chrono::steady_clock::now();
+    std::cerr << EngineStats::format(now, previous, time - last) << std::endl;
+    previous = now;
+    last = time;
+  }
+}
+
+}  // namespace clap::mcts
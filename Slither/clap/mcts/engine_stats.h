@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "clap/mcts/thread_blocks.h"
+
+namespace clap::mcts {
+
+// Search counters of one engine.
+// Every worker thread owns a cache-line aligned block and is its only writer,
+// so an increment is a relaxed load & store without contention; readers sum
+// all blocks on demand.
+class EngineStats {
+ private:
+  struct Block;
+
+ public:
+  enum Counter {
+    kSimulations,
+    kExpansions,
+    kTTProbes,
+    kTTHits,
+    kLabelsResolved,
+    // jobs taken by cpu workers & microseconds they waited for them
+    kQueueWaits,
+    kQueueWaitUs,
+    // forward passes & jobs in them
+    kBatches,
+    kBatchedJobs,
+    kNumCounters
+  };
+  using Snapshot = std::array<uint64_t, kNumCounters>;
+
+  // counts the adds of the calling thread into `stats` while it lives
+  class Scope {
+   public:
+    explicit Scope(EngineStats& stats)
+        : stats(stats), previous(current), block(stats.blocks.acquire()) {
+      current = block;
+    }
+    ~Scope() {
+      current = previous;
+      stats.blocks.release(block);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    EngineStats& stats;
+    Block* previous;
+    Block* block;
+  };
+
+  // a no-op on threads outside any Scope
+  static void add(Counter counter, uint64_t value = 1);
+  Snapshot snapshot() const;
+  void reset();
+  static const char* name(Counter counter);
+  // one line summary, rates are taken against the previous snapshot
+  static std::string format(const Snapshot& now, const Snapshot& previous,
+                            std::chrono::duration<double> elapsed);
+
+ private:
+  struct alignas(64) Block {
+    std::array<std::atomic<uint64_t>, kNumCounters> counters{};
+  };
+
+  static inline thread_local Block* current = nullptr;
+  // blocks outlive their threads so the totals survive stop()
+  ThreadBlocks<Block> blocks;
+};
+
+inline void EngineStats::add(Counter counter, uint64_t value) {
+  if (current == nullptr) return;
+  auto& slot = current->counters[counter];
+  slot.store(slot.load(std::memory_order_relaxed) + value,
+             std::memory_order_relaxed);
+}
+
+// Per-phase value distributions of one engine, collected like EngineStats.
+// Buckets are HDR-style log-linear: every power of two is split into
+// kSubBuckets linear steps, so any recorded value is off by < 1/kSubBuckets.
+class PhaseHistograms {
+ private:
+  struct Block;
+
+ public:
+  enum Phase {
+    kSelectDepth,
+    kSelectNs,
+    kInferenceQueueNs,
+    kBatchAssemblyNs,
+    kForwardNs,
+    kUpdateNs,
+    kCheckCanBlockNs,
+    kWaitExpandNs,
+    kNumPhases
+  };
+
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  struct Summary {
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    double mean;
+    // value at 50%, 90%, 99%, 99.9%
+    std::array<uint64_t, 4> percentiles;
+    // (lower bound, count) of every non-empty bucket
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;
+  };
+
+  // records elapsed nanoseconds into a phase when histograms are enabled
+  class Timer {
+   public:
+    explicit Timer(Phase phase)
+        : phase(phase),
+          begin(PhaseHistograms::recording()
+                    ? std::chrono::steady_clock::now()
+                    : std::chrono::steady_clock::time_point()) {}
+    ~Timer() {
+      if (begin == std::chrono::steady_clock::time_point()) return;
+      PhaseHistograms::record(phase, std::chrono::steady_clock::now() - begin);
+    }
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+   private:
+    Phase phase;
+    std::chrono::steady_clock::time_point begin;
+  };
+
+  // records the calling thread's phases into `histograms` while it lives,
+  // when they are enabled
+  class Scope {
+   public:
+    explicit Scope(PhaseHistograms& histograms)
+        : histograms(histograms),
+          previous(current),
+          block(histograms.enabled ? histograms.blocks.acquire() : nullptr) {
+      current = block;
+    }
+    ~Scope() {
+      current = previous;
+      if (block) histograms.blocks.release(block);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    PhaseHistograms& histograms;
+    Block* previous;
+    Block* block;
+  };
+
+  // whether the calling thread records into an engine's histograms
+  static bool recording() { return current != nullptr; }
+  // for the workers that attach from now on
+  void enable(bool enable) { enabled = enable; }
+
+  static void record(Phase phase, uint64_t value);
+  static void record(Phase phase, std::chrono::steady_clock::duration time) {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    record(phase, static_cast<uint64_t>(std::max<int64_t>(ns, 0)));
+  }
+
+  Summary summary(Phase phase) const;
+  void reset();
+  static const char* name(Phase phase);
+
+  static constexpr int bucket_of(uint64_t value) {
+    if (value < kSubBuckets) return static_cast<int>(value);
+    int exponent = 63;
+    while ((value >> exponent) == 0) --exponent;
+    const int shift = exponent - kSubBucketBits;
+    return (shift + 1) * kSubBuckets +
+           static_cast<int>((value >> shift) - kSubBuckets);
+  }
+  static constexpr uint64_t lower_bound(int bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const int shift = bucket / kSubBuckets - 1;
+    return (static_cast<uint64_t>(kSubBuckets) + bucket % kSubBuckets)
+           << shift;
+  }
+
+ private:
+  struct alignas(64) Block {
+    std::array<std::array<std::atomic<uint64_t>, kNumBuckets>, kNumPhases>
+        buckets{};
+  };
+
+  static inline thread_local Block* current = nullptr;
+  bool enabled = false;
+  // each block is ~62 KB, reused by the workers of every run
+  ThreadBlocks<Block> blocks;
+};
+
+inline void PhaseHistograms::record(Phase phase, uint64_t value) {
+  if (current == nullptr) return;
+  auto& slot = current->buckets[phase][bucket_of(value)];
+  slot.store(slot.load(std::memory_order_relaxed) + 1,
+             std::memory_order_relaxed);
+}
+
+// Prints EngineStats::format of an engine to std::cerr every interval from
+// its own thread.
+class StatsReporter {
+ public:
+  StatsReporter() = default;
+
+  void start(const EngineStats& stats, std::chrono::milliseconds interval);
+  void stop();
+
+  ~StatsReporter() { stop(); }
+
+ private:
+  void run(const EngineStats& stats, std::chrono::milliseconds interval);
+
+  std::mutex mutex;
+  std::condition_variable stopped;
+  bool running = false;
+  std::thread thread;
+};
+
+}  // namespace clap::mcts
@@ -1,12 +1,15 @@
 #include "clap/mcts/job.h"
 
+#include "clap/game/slither/slither.h"
 #include "clap/mcts/engine.h"
+#include "clap/mcts/engine_stats.h"
 #include "clap/mcts/node.h"
 #include "clap/mcts/tree.h"
 
 namespace clap::mcts {
 
-Job::Job(Engine* engine, const std::string& serialize_string)
+template <class StateT>
+BasicJob<StateT>::BasicJob(Engine* engine, const std::string& serialize_string)
     : engine(engine),
       next_step(Step::SELECT),
       root_state(engine->game->new_initial_state()) {
@@ -15,9 +18,10 @@ Job::Job(Engine* engine, const std::string& serialize_string)
   }
 }
 
-void Job::select(std::mt19937& rng) {
+template <class StateT>
+void BasicJob<StateT>::select(std::mt19937& rng) {
   auto* leaf_node = &tree.root_node;
-  leaf_state = root_state->clone();
+  leaf_state = root_state;
 
   game::Player previous_player = leaf_state->current_player();
 
@@ -49,7 +53,8 @@ void Job::select(std::mt19937& rng) {
   }
 }
 
-void Job::evaluate() {
+template <class StateT>
+void BasicJob<StateT>::evaluate() {
   const auto& observation_tensor_shape =
       engine->game->observation_tensor_shape();
   std::vector<int64_t> input_shape(observation_tensor_shape.begin(),
@@ -73,8 +78,8 @@ void Job::evaluate() {
 
   // inference
   auto results = model_ptr->forward({input_tensor}).toTuple()->elements();
-  auto batch_policy = results[0].toTensor().cpu();
-  auto batch_value = results[1].toTensor().cpu();
+  torch::Tensor batch_policy = results[0].toTensor().cpu();
+  torch::Tensor batch_value = results[1].toTensor().cpu();
 
   const auto& policy_ptr = batch_policy[0].data_ptr<float>();
   const auto& policy_size = batch_policy[0].numel();
@@ -84,10 +89,11 @@ void Job::evaluate() {
   const auto& value_size = batch_value[0].numel();
   leaf_returns.assign(value_ptr, value_ptr + value_size);
 
-  next_step = Job::Step::UPDATE;
+  next_step = Step::UPDATE;
 }
 
-void Job::update(std::mt19937& rng) {
+template <class StateT>
+void BasicJob<StateT>::update(std::mt19937& rng) {
   for (const auto& [parent_player, current_player, node] : selection_path) {
     ++node->num_visits;
     node->parent_player_value_sum += leaf_returns[parent_player];
@@ -108,6 +114,7 @@ void Job::update(std::mt19937& rng) {
     // first simulation -> add dirichlet noise to root policy
     if (tree.num_simulations() == 1) tree.add_dirichlet_noise(rng);
   }
+  EngineStats::add(EngineStats::kSimulations);
 
   if (tree.root_node.num_visits >= Engine::max_simulations) {
     next_step = Step::PLAY;
@@ -116,7 +123,8 @@ void Job::update(std::mt19937& rng) {
   }
 }
 
-void Job::play(std::mt19937& rng) {
+template <class StateT>
+void BasicJob<StateT>::play(std::mt19937& rng) {
   const clap::game::Player player = root_state->current_player();
   clap::mcts::Node* parent_node_ptr = &tree.root_node;
 
@@ -193,7 +201,8 @@ void Job::play(std::mt19937& rng) {
   }
 }
 
-void Job::report() {
+template <class StateT>
+void BasicJob<StateT>::report() {
   if (Engine::report_serialize_string) {
     trajectory.set_appendix(root_state->serialize());
   }
@@ -212,4 +221,7 @@ void Job::report() {
   }
 }
 
+template class BasicJob<game::State>;
+template class BasicJob<game::slither::SlitherState>;
+
 }  // namespace clap::mcts
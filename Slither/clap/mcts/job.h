@@ -1,23 +1,28 @@
 #pragma once
 
+#include <chrono>
 #include <random>
 #include <tuple>
 #include <vector>
 
 #include "clap/game/game.h"
+#include "clap/mcts/state_holder.h"
 #include "clap/mcts/tree.h"
 #include "clap/pb/clap.pb.h"
 
 namespace clap::mcts {
 
 class Node;
-class Engine;
+template <class StateT>
+class BasicEngine;
 
-class Job {
+template <class StateT>
+class BasicJob {
  public:
+  using Engine = BasicEngine<StateT>;
   enum Step { SELECT, EVALUATE, UPDATE, PLAY, REPORT, DONE };
 
-  Job(Engine* engine, const std::string& serialize_string = "");
+  BasicJob(Engine* engine, const std::string& serialize_string = "");
   void select(std::mt19937& rng);
   void evaluate();
   void update(std::mt19937& rng);
@@ -26,16 +31,20 @@ class Job {
 
   void print_mcts_results(const int top_n, const Node& parent_node) const;
   void PreOrderTraversalDump(std::ofstream& sgf_file_, const Node& current_node,
-                             const game::StatePtr& current_state,
+                             game::State& current_state,
                              const float& prior, const int& parent_num_visits,
                              const game::Action& last_action) const;
   void dump_mcts() const;
 
   Engine* engine;
   Step next_step;
+  // cpu worker that selected this job, -1 if it never left one
+  int worker = -1;
+  // when the job was queued for inference
+  std::chrono::steady_clock::time_point evaluate_begin;
 
   // select
-  game::StatePtr leaf_state;
+  StateHolder<StateT> leaf_state;
   std::vector<float> leaf_observation;
   // previous player, current player, node ptr
   std::vector<std::tuple<game::Player, game::Player, Node*>> selection_path;
@@ -45,9 +54,9 @@ class Job {
   // update
   Tree tree;
   // play
-  game::StatePtr root_state;
+  StateHolder<StateT> root_state;
   // report
   clap::pb::Trajectory trajectory;
 };
 
-}  // namespace clap::mcts
\ No newline at end of file
+}  // namespace clap::mcts
@@ -2,9 +2,11 @@
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
 #include "clap/game/game.h"
+#include "clap/game/slither/slither.h"
 #include "clap/mcts/engine.h"
 #include "clap/mcts/job.h"
 #include "clap/mcts/node.h"
@@ -12,7 +14,9 @@
 
 namespace clap::mcts {
 
-void Job::print_mcts_results(const int top_n, const Node& parent_node) const {
+template <class StateT>
+void BasicJob<StateT>::print_mcts_results(const int top_n,
+                                          const Node& parent_node) const {
   std::vector<int> children_index;
   for (int i = 0; i < parent_node.children.size(); i++) {
     children_index.push_back(i);
@@ -50,21 +54,21 @@ void Job::print_mcts_results(const int top_n, const Node& parent_node) const {
 
 const std::vector<std::string> color{"B", "W", "UNKNOWN"};
 
-void Job::PreOrderTraversalDump(std::ofstream& sgf_file_,
-                                const Node& current_node,
-                                const game::StatePtr& parent_state,
-                                const float& prior,
-                                const int& parent_num_visits,
-                                const game::Action& last_action) const {
-  game::StatePtr current_state = parent_state->clone();
+template <class StateT>
+void BasicJob<StateT>::PreOrderTraversalDump(
+    std::ofstream& sgf_file_, const Node& current_node,
+    game::State& parent_state, const float& prior,
+    const int& parent_num_visits, const game::Action& last_action) const {
+  // the child position, made in place when the game supports undo
+  std::optional<game::ScopedAction> move;
   if (&current_node == &tree.root_node) {
     sgf_file_ << ";GM[CLAP]";
     // GM[CLAP]
-    // sgf_file_ << parent_state->serialize();
-    sgf_file_ << parent_state->serialize_num_to_char();
+    // sgf_file_ << parent_state.serialize();
+    sgf_file_ << parent_state.serialize_num_to_char();
     // ;B[KJ];W[KI];W[LJ];B[MK];B[ML];W[LK];W[LI];B[MI];B[MJ];W[MH];W[NH];B[MM];B[MN]
   } else {
-    sgf_file_ << color[parent_state->current_player()] << "["
+    sgf_file_ << color[parent_state.current_player()] << "["
               << engine->game->action_to_string(last_action) << "]";
     // sgf_file_ << "\r\nC[Simulation Count: " << current_node.num_visits << "\r\n";
     // sgf_file_ << "MCTS Value: "
@@ -76,8 +80,9 @@ void Job::PreOrderTraversalDump(std::ofstream& sgf_file_,
     //           << "\r\n]";
     // char label_char[] = "BWN";
     // sgf_file_ << "\r\nC[Label: " << label_char[current_node.label] << "\r\n]";
-    current_state->apply_action(last_action);
+    move.emplace(parent_state, last_action);
   }
+  game::State& current_state = move ? move->state() : parent_state;
   bool hasBranch = 0;
   for(auto child: current_node.children){
     if (std::get<2>(child).num_visits != 0){
@@ -103,7 +108,8 @@ void Job::PreOrderTraversalDump(std::ofstream& sgf_file_,
 
 }
 
-void Job::dump_mcts() const {
+template <class StateT>
+void BasicJob<StateT>::dump_mcts() const {
   const game::GamePtr& game = engine->game;
   std::ofstream sgf_file_;
   std::time_t now = std::time(0);
@@ -115,7 +121,7 @@ void Job::dump_mcts() const {
      << 'D' << ltm->tm_hour << ':' << ltm->tm_min << ':' << ltm->tm_sec;
   std::string filename = folder + "MCTS_" + dt.str() + ".sgf";
   sgf_file_.open(filename);
-  PreOrderTraversalDump(sgf_file_, tree.root_node, root_state, 1.0,
+  PreOrderTraversalDump(sgf_file_, tree.root_node, *root_state->clone(), 1.0,
                         tree.root_node.num_visits, 0);
   sgf_file_.close();
   system(("./parser "+filename).c_str());
@@ -123,4 +129,12 @@ void Job::dump_mcts() const {
   // (;GM[7]FF[4];B[KJ];W[KI];W[LJ];B[MK];B[ML];W[LK];W[LI];B[MI];B[MJ];W[MH];W[NH];B[MM];B[MN])
   // (;GM[511];B[JJ](;W[JH];W[MK])(;W[JH];W[JN])(;W[JH];W[FK];B[FF])(;W[JH];W[PO](;B[NH];B[PJ];W[MM];W[KL])(;B[NH];B[MK])))
 }
+
+template void BasicJob<game::State>::print_mcts_results(const int,
+                                                       const Node&) const;
+template void BasicJob<game::State>::dump_mcts() const;
+template void BasicJob<game::slither::SlitherState>::print_mcts_results(
+    const int, const Node&) const;
+template void BasicJob<game::slither::SlitherState>::dump_mcts() const;
+
 }  // namespace clap::mcts
@@ -2,6 +2,7 @@
 
 #include <torch/cuda.h>
 #include <torch/script.h>
+#include <torch/torch.h>
 
 namespace clap::mcts {
 
@@ -9,16 +10,30 @@ ModelManager::ModelManager(const std::vector<int>& gpus, int num_versions)
     : devices(ModelManager::torch_devices(gpus)),
       toggle(num_versions),
       device_switch(num_versions),
-      models(devices.size()) {
+      models(devices.size()),
+      native_models(num_versions) {
   for (auto& model_d : models) model_d.resize(num_versions);
 }
 
-void ModelManager::load(const std::string& path, int version) {
+void ModelManager::load(const std::string& path, int version, bool optimize,
+                        const std::vector<int64_t>& warmup_shape) {
   const auto new_toggle = toggle[version] ^ 1;
   for (int d_i = 0; d_i < devices.size(); ++d_i) {
     const auto& device = devices[d_i];
-    models[d_i][version][new_toggle] =
-        std::make_shared<Model>(torch::jit::load(path, device));
+    auto model = torch::jit::load(path, device);
+    model.eval();
+    if (optimize) {
+      model = torch::jit::freeze(model);
+      model = torch::jit::optimize_for_inference(model);
+    }
+    // the first forwards profile & compile the graph, keep them off the
+    // search path
+    if (!warmup_shape.empty()) {
+      torch::NoGradGuard no_grad;
+      const auto input = torch::zeros(warmup_shape).to(device);
+      for (int i = 0; i < kWarmupRuns; ++i) model.forward({input});
+    }
+    models[d_i][version][new_toggle] = std::make_shared<Model>(model);
   }
   toggle[version] ^= 1;
 }
@@ -31,11 +46,29 @@ std::tuple<torch::Device, ModelManager::ModelPtr> ModelManager::get(
           models[device_index][version][toggle[version]]};
 }
 
+void ModelManager::load_native(const std::string& path, int version) {
+  const auto new_toggle = toggle[version] ^ 1;
+  native_models[version][new_toggle] = NativeModel::load(path);
+  toggle[version] ^= 1;
+}
+
+std::shared_ptr<NativeModel> ModelManager::get_native(int version) {
+  return native_models[version][toggle[version]];
+}
+
 std::vector<torch::Device> ModelManager::torch_devices(
     const std::vector<int>& gpus) {
   std::vector<torch::Device> cuda_devices;
   cuda_devices.reserve(gpus.size());
-  for (const auto& gpu : gpus) cuda_devices.emplace_back(torch::kCUDA, gpu);
+  // a negative gpu index or no gpu at all runs inference on the CPU
+  for (const auto& gpu : gpus) {
+    if (gpu < 0) {
+      cuda_devices.emplace_back(torch::kCPU);
+    } else {
+      cuda_devices.emplace_back(torch::kCUDA, gpu);
+    }
+  }
+  if (cuda_devices.empty()) cuda_devices.emplace_back(torch::kCPU);
   return cuda_devices;
 }
 
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "clap/game/game.h"
+#include "clap/mcts/native_model.h"
 
 namespace clap::mcts {
 
@@ -17,13 +18,21 @@ class ModelManager {
   using ModelPtr = std::shared_ptr<Model>;
 
   ModelManager(const std::vector<int>& gpus, int num_versions = 1);
-  void load(const std::string& path, int version = 0);
+  // optimize: freeze the module and run optimize_for_inference
+  // warmup_shape: run a few dummy batches of this shape before swapping in
+  void load(const std::string& path, int version = 0, bool optimize = false,
+            const std::vector<int64_t>& warmup_shape = {});
   std::tuple<torch::Device, ModelPtr> get(int version = 0);
+  // CPU-only backend, see NativeModel
+  void load_native(const std::string& path, int version = 0);
+  std::shared_ptr<NativeModel> get_native(int version = 0);
   ~ModelManager() = default;
 
  private:
   static std::vector<torch::Device> torch_devices(const std::vector<int>& gpus);
 
+  static constexpr int kWarmupRuns = 3;
+
   // inference devices
   const std::vector<torch::Device> devices;
   // toggle[version] 0 <-> 1
@@ -32,6 +41,8 @@ class ModelManager {
   std::vector<std::atomic_int> device_switch;
   // models[device][version][toggle]
   std::vector<std::vector<std::array<ModelPtr, 2>>> models;
+  // native_models[version][toggle]
+  std::vector<std::array<std::shared_ptr<NativeModel>, 2>> native_models;
 };
 
 }  // namespace clap::mcts
@@ -1,6 +1,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include "clap/game/slither/slither.h"
 #include "clap/mcts/engine.h"
 #include "clap/mcts/vl/engine.h"
 
@@ -10,83 +11,232 @@ namespace {
 namespace py = ::pybind11;
 using py::literals::operator""_a;
 
-PYBIND11_MODULE(mcts, m) {  // NOLINT
-  py::class_<Engine>(m, "Engine")
+py::dict batching_stats(BatchController& controller) {
+  const auto stats = controller.stats();
+  py::dict dict;
+  dict["batch_cutoff"] = stats.batch_cutoff;
+  dict["wait_us"] = stats.wait_us;
+  dict["offered_load"] = stats.offered_load;
+  dict["mean_latency_us"] = stats.mean_latency_us;
+  dict["latency_histogram"] = stats.latency_histogram;
+  return dict;
+}
+
+template <class T>
+py::dict scheduling_stats(const WorkScheduler<T>& scheduler) {
+  const auto stats = scheduler.stats();
+  py::dict dict;
+  dict["local"] = stats.local;
+  dict["injected"] = stats.injected;
+  dict["stolen"] = stats.stolen;
+  return dict;
+}
+
+py::list thread_layout(const ThreadPlacement& placement) {
+  py::list layout;
+  for (const auto& slot : placement.layout()) {
+    layout.append(py::dict("role"_a = slot.role, "index"_a = slot.index,
+                           "cpus"_a = slot.cpus, "node"_a = slot.node));
+  }
+  return layout;
+}
+
+py::dict engine_stats(const EngineStats& stats) {
+  const auto snapshot = stats.snapshot();
+  py::dict dict;
+  for (int i = 0; i < EngineStats::kNumCounters; ++i) {
+    dict[EngineStats::name(static_cast<EngineStats::Counter>(i))] =
+        snapshot[i];
+  }
+  return dict;
+}
+
+py::dict phase_histograms(const PhaseHistograms& histograms) {
+  py::dict dict;
+  for (int i = 0; i < PhaseHistograms::kNumPhases; ++i) {
+    const auto phase = static_cast<PhaseHistograms::Phase>(i);
+    const auto summary = histograms.summary(phase);
+    const auto& [p50, p90, p99, p999] = summary.percentiles;
+    dict[PhaseHistograms::name(phase)] = py::dict(
+        "count"_a = summary.count, "min"_a = summary.min,
+        "max"_a = summary.max, "mean"_a = summary.mean, "p50"_a = p50,
+        "p90"_a = p90, "p99"_a = p99, "p999"_a = p999,
+        "buckets"_a = summary.buckets);
+  }
+  return dict;
+}
+
+// the search parameters are EngineConfig statics, shared by both classes
+template <class EngineT>
+void bind_engine(py::module& m, const char* name) {
+  py::class_<EngineT>(m, name)
       .def(py::init<const std::vector<int>&, int>(), "gpus"_a, "models"_a = 1)
-      .def_readwrite_static("batch_size", &Engine::batch_size)
-      .def_readwrite_static("max_simulations", &Engine::max_simulations)
-      .def_readwrite_static("c_puct", &Engine::c_puct)
-      .def_readwrite_static("dirichlet_alpha", &Engine::dirichlet_alpha)
-      .def_readwrite_static("dirichlet_epsilon", &Engine::dirichlet_epsilon)
-      .def_readwrite_static("float_error", &Engine::float_error)
+      .def_readwrite_static("batch_size", &EngineT::batch_size)
+      .def_readwrite_static("max_simulations", &EngineT::max_simulations)
+      .def_readwrite_static("c_puct", &EngineT::c_puct)
+      .def_readwrite_static("dirichlet_alpha", &EngineT::dirichlet_alpha)
+      .def_readwrite_static("dirichlet_epsilon", &EngineT::dirichlet_epsilon)
+      .def_readwrite_static("float_error", &EngineT::float_error)
       .def_readwrite_static("num_sampled_transformations",
-                            &Engine::num_sampled_transformations)
-      .def_readwrite_static("batch_per_job", &Engine::batch_per_job)
-      .def_readwrite_static("temperature_drop", &Engine::temperature_drop)
-      .def_readwrite_static("inference_wait_ms", &Engine::inference_wait_ms)
-      .def_readwrite_static("play_until_terminal", &Engine::play_until_terminal)
-      .def_readwrite_static("auto_reset_job", &Engine::auto_reset_job)
+                            &EngineT::num_sampled_transformations)
+      .def_readwrite_static("batch_per_job", &EngineT::batch_per_job)
+      .def_readwrite_static("temperature_drop", &EngineT::temperature_drop)
+      .def_readwrite_static("inference_wait_ms", &EngineT::inference_wait_ms)
+      .def_readwrite_static("adaptive_batching", &EngineT::adaptive_batching)
+      .def_readwrite_static("pipelined_inference",
+                            &EngineT::pipelined_inference)
+      .def_readwrite_static("optimize_model", &EngineT::optimize_model)
+      .def_readwrite_static("warmup_model", &EngineT::warmup_model)
+      .def_readwrite_static("native_inference",
+                            &EngineT::native_inference)
+      .def_readwrite_static("cpu_worker_cores", &EngineT::cpu_worker_cores)
+      .def_readwrite_static("gpu_worker_cores", &EngineT::gpu_worker_cores)
+      .def_readwrite_static("auto_affinity", &EngineT::auto_affinity)
+      .def_readwrite_static("numa_interleave", &EngineT::numa_interleave)
+      .def_readwrite_static("stats_interval_ms", &EngineT::stats_interval_ms)
+      .def_readwrite_static("trace_path", &EngineT::trace_path)
+      .def_readwrite_static("phase_histograms", &EngineT::phase_histograms)
+      .def_readwrite_static("stub_inference", &EngineT::stub_inference)
+      .def_readwrite_static("stub_latency_us", &EngineT::stub_latency_us)
+      .def_readwrite_static("deterministic", &EngineT::deterministic)
+      .def_readwrite_static("seed", &EngineT::seed)
+      .def_readwrite_static("play_until_terminal", &EngineT::play_until_terminal)
+      .def_readwrite_static("auto_reset_job", &EngineT::auto_reset_job)
       .def_readwrite_static("play_until_turn_player",
-                            &Engine::play_until_turn_player)
+                            &EngineT::play_until_turn_player)
       .def_readwrite_static("mcts_until_turn_player",
-                            &Engine::mcts_until_turn_player)
-      .def_readwrite_static("verbose", &Engine::verbose)
-      .def_readwrite_static("top_n_childs", &Engine::top_n_childs)
+                            &EngineT::mcts_until_turn_player)
+      .def_readwrite_static("verbose", &EngineT::verbose)
+      .def_readwrite_static("top_n_childs", &EngineT::top_n_childs)
       .def_readwrite_static("states_value_using_childs",
-                            &Engine::states_value_using_childs)
-      .def_readwrite_static("dump_tree", &Engine::dump_tree)
-      .def_readwrite_static("save_observation", &Engine::save_observation)
-      .def_readwrite_static("report_serialize_string", &Engine::report_serialize_string)
-      .def("load_game", &Engine::load_game, "name"_a)
-      .def("load_model", &Engine::load_model, "path"_a, "version"_a = 0)
-      .def("start", &Engine::start, "cpu_workers"_a, "gpu_workers"_a,
+                            &EngineT::states_value_using_childs)
+      .def_readwrite_static("dump_tree", &EngineT::dump_tree)
+      .def_readwrite_static("save_observation", &EngineT::save_observation)
+      .def_readwrite_static("report_serialize_string", &EngineT::report_serialize_string)
+      .def("load_game", &EngineT::load_game, "name"_a)
+      .def("load_model", &EngineT::load_model, "path"_a, "version"_a = 0)
+      .def("start", &EngineT::start, "cpu_workers"_a, "gpu_workers"_a,
            "num_envs"_a = -1)
-      .def("stop", &Engine::stop)
+      .def("stop", &EngineT::stop)
+      .def("get_batching_stats",
+           [](EngineT& engine) {
+             return batching_stats(engine.batch_controller);
+           })
+      .def("get_scheduling_stats",
+           [](EngineT& engine) { return scheduling_stats(engine.cpu_jobs); })
+      .def("get_thread_layout",
+           [](EngineT& engine) {
+             return thread_layout(engine.thread_placement);
+           })
+      .def("get_stats",
+           [](EngineT& engine) { return engine_stats(engine.stats); })
+      .def("get_histograms",
+           [](EngineT& engine) { return phase_histograms(engine.histograms); })
+      .def("reset_stats",
+           [](EngineT& engine) {
+             engine.stats.reset();
+             engine.histograms.reset();
+           })
 
-      .def("add_job", &Engine::add_job, "num"_a = 1, "serialize_string"_a = "")
+      .def("add_job", &EngineT::add_job, "num"_a = 1, "serialize_string"_a = "")
 
       .def(
           "get_trajectory",
-          [](Engine& engine) { return py::bytes(engine.get_trajectory()); },
+          [](EngineT& engine) { return py::bytes(engine.get_trajectory()); },
           py::call_guard<py::gil_scoped_release>());
+}
 
-  py::class_<vl::Engine>(m, "VLEngine")
+// the search parameters are vl::EngineConfig statics, shared by both classes
+template <class EngineT>
+void bind_vl_engine(py::module& m, const char* name) {
+  py::class_<EngineT>(m, name)
       .def(py::init<const std::vector<int>&, int>(), "gpus"_a, "models"_a = 1)
-      .def_readwrite_static("batch_size", &vl::Engine::batch_size)
-      .def_readwrite_static("max_simulations", &vl::Engine::max_simulations)
-      .def_readwrite_static("c_puct", &vl::Engine::c_puct)
-      .def_readwrite_static("dirichlet_alpha", &vl::Engine::dirichlet_alpha)
-      .def_readwrite_static("dirichlet_epsilon", &vl::Engine::dirichlet_epsilon)
-      .def_readwrite_static("float_error", &vl::Engine::float_error)
+      .def_readwrite_static("batch_size", &EngineT::batch_size)
+      .def_readwrite_static("max_simulations", &EngineT::max_simulations)
+      .def_readwrite_static("c_puct", &EngineT::c_puct)
+      .def_readwrite_static("dirichlet_alpha", &EngineT::dirichlet_alpha)
+      .def_readwrite_static("dirichlet_epsilon", &EngineT::dirichlet_epsilon)
+      .def_readwrite_static("float_error", &EngineT::float_error)
       .def_readwrite_static("num_sampled_transformations",
-                            &vl::Engine::num_sampled_transformations)
-      .def_readwrite_static("batch_per_job", &vl::Engine::batch_per_job)
-      .def_readwrite_static("temperature_drop", &vl::Engine::temperature_drop)
-      .def_readwrite_static("inference_wait_ms", &vl::Engine::inference_wait_ms)
-      .def_readwrite_static("virtual_loss", &vl::Engine::virtual_loss)
-      .def_readwrite_static("play_until_terminal", &vl::Engine::play_until_terminal)
-      .def_readwrite_static("auto_reset_job", &vl::Engine::auto_reset_job)
+                            &EngineT::num_sampled_transformations)
+      .def_readwrite_static("batch_per_job", &EngineT::batch_per_job)
+      .def_readwrite_static("temperature_drop", &EngineT::temperature_drop)
+      .def_readwrite_static("inference_wait_ms", &EngineT::inference_wait_ms)
+      .def_readwrite_static("adaptive_batching", &EngineT::adaptive_batching)
+      .def_readwrite_static("pipelined_inference",
+                            &EngineT::pipelined_inference)
+      .def_readwrite_static("optimize_model", &EngineT::optimize_model)
+      .def_readwrite_static("warmup_model", &EngineT::warmup_model)
+      .def_readwrite_static("native_inference",
+                            &EngineT::native_inference)
+      .def_readwrite_static("cpu_worker_cores", &EngineT::cpu_worker_cores)
+      .def_readwrite_static("gpu_worker_cores", &EngineT::gpu_worker_cores)
+      .def_readwrite_static("auto_affinity", &EngineT::auto_affinity)
+      .def_readwrite_static("numa_interleave", &EngineT::numa_interleave)
+      .def_readwrite_static("stats_interval_ms", &EngineT::stats_interval_ms)
+      .def_readwrite_static("trace_path", &EngineT::trace_path)
+      .def_readwrite_static("phase_histograms", &EngineT::phase_histograms)
+      .def_readwrite_static("stub_inference", &EngineT::stub_inference)
+      .def_readwrite_static("stub_latency_us", &EngineT::stub_latency_us)
+      .def_readwrite_static("deterministic", &EngineT::deterministic)
+      .def_readwrite_static("seed", &EngineT::seed)
+      .def_readwrite_static("tactical_oracle", &EngineT::tactical_oracle)
+      .def_readwrite_static("cache_entries", &EngineT::cache_entries)
+      .def_readwrite_static("virtual_loss", &EngineT::virtual_loss)
+      .def_readwrite_static("play_until_terminal", &EngineT::play_until_terminal)
+      .def_readwrite_static("auto_reset_job", &EngineT::auto_reset_job)
       .def_readwrite_static("play_until_turn_player",
-                            &vl::Engine::play_until_turn_player)
+                            &EngineT::play_until_turn_player)
       .def_readwrite_static("mcts_until_turn_player",
-                            &vl::Engine::mcts_until_turn_player)
-      .def_readwrite_static("verbose", &vl::Engine::verbose)
-      .def_readwrite_static("top_n_childs", &vl::Engine::top_n_childs)
+                            &EngineT::mcts_until_turn_player)
+      .def_readwrite_static("verbose", &EngineT::verbose)
+      .def_readwrite_static("top_n_childs", &EngineT::top_n_childs)
       .def_readwrite_static("states_value_using_childs",
-                            &vl::Engine::states_value_using_childs)
-      .def("load_game", &vl::Engine::load_game, "name"_a)
-      .def("load_model", &vl::Engine::load_model, "path"_a, "version"_a = 0)
-      .def("start", &vl::Engine::start, "cpu_workers"_a, "gpu_workers"_a,
+                            &EngineT::states_value_using_childs)
+      .def("load_game", &EngineT::load_game, "name"_a)
+      .def("load_model", &EngineT::load_model, "path"_a, "version"_a = 0)
+      .def("start", &EngineT::start, "cpu_workers"_a, "gpu_workers"_a,
            "num_envs"_a = -1)
-      .def("stop", &vl::Engine::stop)
+      .def("stop", &EngineT::stop)
+      .def("get_batching_stats",
+           [](EngineT& engine) {
+             return batching_stats(engine.batch_controller);
+           })
+      .def("get_scheduling_stats",
+           [](EngineT& engine) { return scheduling_stats(engine.cpu_jobs); })
+      .def("get_thread_layout",
+           [](EngineT& engine) {
+             return thread_layout(engine.thread_placement);
+           })
+      .def("get_stats",
+           [](EngineT& engine) { return engine_stats(engine.stats); })
+      .def("get_histograms",
+           [](EngineT& engine) {
+             return phase_histograms(engine.histograms);
+           })
+      .def("reset_stats",
+           [](EngineT& engine) {
+             engine.stats.reset();
+             engine.histograms.reset();
+           })
 
-      .def("add_job", &vl::Engine::add_job, "num"_a = 1, "serialize_string"_a = "")
+      .def("add_job", &EngineT::add_job, "num"_a = 1, "serialize_string"_a = "")
 
       .def(
           "get_trajectory",
-          [](vl::Engine& engine) { return py::bytes(engine.get_trajectory()); },
+          [](EngineT& engine) { return py::bytes(engine.get_trajectory()); },
           py::call_guard<py::gil_scoped_release>());
 }
 
+PYBIND11_MODULE(mcts, m) {  // NOLINT
+  bind_engine<Engine>(m, "Engine");
+  // Engine specialised for slither states
+  bind_engine<SlitherEngine>(m, "SlitherEngine");
+
+  bind_vl_engine<vl::Engine>(m, "VLEngine");
+  // VLEngine specialised for slither states
+  bind_vl_engine<vl::SlitherEngine>(m, "SlitherVLEngine");
+}
+
 }  // namespace
 }  // namespace clap::mcts
@@ -0,0 +1,251 @@
+#include "clap/mcts/native_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace clap::mcts {
+
+namespace {
+
+// y[o] += sum_j x[j] * w[j * m + o] for o in [0, m)
+// accumulators stay in registers for a whole column block
+void gemv(const float* x, int n, const float* w, int m, float* y) {
+  int o = 0;
+#ifdef __AVX512F__
+  for (; o + 32 <= m; o += 32) {
+    __m512 acc0 = _mm512_loadu_ps(y + o);
+    __m512 acc1 = _mm512_loadu_ps(y + o + 16);
+    for (int j = 0; j < n; ++j) {
+      const __m512 xj = _mm512_set1_ps(x[j]);
+      const float* wj = w + j * m + o;
+      acc0 = _mm512_fmadd_ps(xj, _mm512_loadu_ps(wj), acc0);
+      acc1 = _mm512_fmadd_ps(xj, _mm512_loadu_ps(wj + 16), acc1);
+    }
+    _mm512_storeu_ps(y + o, acc0);
+    _mm512_storeu_ps(y + o + 16, acc1);
+  }
+  for (; o + 16 <= m; o += 16) {
+    __m512 acc = _mm512_loadu_ps(y + o);
+    for (int j = 0; j < n; ++j) {
+      acc = _mm512_fmadd_ps(_mm512_set1_ps(x[j]),
+                            _mm512_loadu_ps(w + j * m + o), acc);
+    }
+    _mm512_storeu_ps(y + o, acc);
+  }
+#elif defined(__AVX2__)
+  for (; o + 32 <= m; o += 32) {
+    __m256 acc0 = _mm256_loadu_ps(y + o);
+    __m256 acc1 = _mm256_loadu_ps(y + o + 8);
+    __m256 acc2 = _mm256_loadu_ps(y + o + 16);
+    __m256 acc3 = _mm256_loadu_ps(y + o + 24);
+    for (int j = 0; j < n; ++j) {
+      const __m256 xj = _mm256_set1_ps(x[j]);
+      const float* wj = w + j * m + o;
+      acc0 = _mm256_fmadd_ps(xj, _mm256_loadu_ps(wj), acc0);
+      acc1 = _mm256_fmadd_ps(xj, _mm256_loadu_ps(wj + 8), acc1);
+      acc2 = _mm256_fmadd_ps(xj, _mm256_loadu_ps(wj + 16), acc2);
+      acc3 = _mm256_fmadd_ps(xj, _mm256_loadu_ps(wj + 24), acc3);
+    }
+    _mm256_storeu_ps(y + o, acc0);
+    _mm256_storeu_ps(y + o + 8, acc1);
+    _mm256_storeu_ps(y + o + 16, acc2);
+    _mm256_storeu_ps(y + o + 24, acc3);
+  }
+  for (; o + 8 <= m; o += 8) {
+    __m256 acc = _mm256_loadu_ps(y + o);
+    for (int j = 0; j < n; ++j) {
+      acc = _mm256_fmadd_ps(_mm256_set1_ps(x[j]),
+                            _mm256_loadu_ps(w + j * m + o), acc);
+    }
+    _mm256_storeu_ps(y + o, acc);
+  }
+#endif
+  // rows outer so the compiler can vectorize the remaining columns
+  for (int j = 0; j < n; ++j) {
+    const float xj = x[j];
+    const float* wj = w + j * m;
+    for (int i = o; i < m; ++i) y[i] += xj * wj[i];
+  }
+}
+
+void relu(float* x, int n) {
+  for (int i = 0; i < n; ++i) x[i] = std::max(x[i], 0.0F);
+}
+
+// fused affine layer: y = b + x * W
+void linear(const float* x, int n, const std::vector<float>& w,
+            const std::vector<float>& b, float* y) {
+  std::copy(b.begin(), b.end(), y);
+  gemv(x, n, w.data(), b.size(), y);
+}
+
+// 1x1 conv from channels-last (cells, in) into channel-major (out, cells),
+// which is the order torch flattens the heads in
+void conv1x1(const float* x, int cells, int in, const std::vector<float>& w,
+             const std::vector<float>& b, float* y) {
+  const int out = b.size();
+  for (int c = 0; c < out; ++c) {
+    const float* wc = w.data() + c * in;
+    for (int p = 0; p < cells; ++p) {
+      const float* xp = x + p * in;
+      float acc = b[c];
+      for (int i = 0; i < in; ++i) acc += xp[i] * wc[i];
+      y[c * cells + p] = std::max(acc, 0.0F);
+    }
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<NativeModel> NativeModel::load(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) throw std::runtime_error("cannot open native model " + path);
+
+  uint32_t magic = 0, version = 0;
+  in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  if (magic != kMagic || version != kVersion)
+    throw std::runtime_error(path + " is not a native model (version " +
+                             std::to_string(kVersion) + ")");
+
+  auto model = std::make_shared<NativeModel>();
+  int32_t header[7];
+  in.read(reinterpret_cast<char*>(header), sizeof(header));
+  model->in_channels = header[0];
+  model->height = header[1];
+  model->width = header[2];
+  model->channels = header[3];
+  model->blocks = header[4];
+  model->num_actions = header[5];
+  model->num_players = header[6];
+
+  const int cells = model->height * model->width;
+  const int c = model->channels;
+  model->read_layer(in, model->stem, 9 * model->in_channels, c);
+  model->convs.resize(2 * model->blocks);
+  for (auto& conv : model->convs) model->read_layer(in, conv, 9 * c, c);
+  model->read_layer(in, model->policy_conv, c, 2);
+  model->read_layer(in, model->policy_fc, 2 * cells, model->num_actions);
+  model->read_layer(in, model->value_conv, c, 1);
+  model->read_layer(in, model->value_fc1, cells, c);
+  model->read_layer(in, model->value_fc2, c, model->num_players);
+  if (!in) throw std::runtime_error("truncated native model " + path);
+
+  // 3x3 neighbourhood of every cell, row-major over (dy, dx)
+  model->neighbours.resize(cells * 9);
+  for (int y = 0; y < model->height; ++y) {
+    for (int x = 0; x < model->width; ++x) {
+      for (int k = 0; k < 9; ++k) {
+        const int ny = y + k / 3 - 1;
+        const int nx = x + k % 3 - 1;
+        const bool inside =
+            ny >= 0 && ny < model->height && nx >= 0 && nx < model->width;
+        model->neighbours[(y * model->width + x) * 9 + k] =
+            inside ? ny * model->width + nx : -1;
+      }
+    }
+  }
+  return model;
+}
+
+void NativeModel::read_layer(std::istream& in, Layer& layer, int in_size,
+                             int out_size) {
+  layer.in_size = in_size;
+  layer.out_size = out_size;
+  layer.weight.resize(static_cast<size_t>(in_size) * out_size);
+  layer.bias.resize(out_size);
+  in.read(reinterpret_cast<char*>(layer.weight.data()),
+          layer.weight.size() * sizeof(float));
+  in.read(reinterpret_cast<char*>(layer.bias.data()),
+          layer.bias.size() * sizeof(float));
+}
+
+void NativeModel::conv3x3(const Layer& layer, const float* input,
+                          float* output, const float* residual,
+                          std::vector<float>& column) const {
+  const int cells = height * width;
+  const int in = layer.in_size / 9;
+  const int out = layer.out_size;
+  for (int p = 0; p < cells; ++p) {
+    // im2col for a single cell, zero padded at the border
+    for (int k = 0; k < 9; ++k) {
+      const int q = neighbours[p * 9 + k];
+      float* dst = column.data() + k * in;
+      if (q < 0) {
+        std::fill(dst, dst + in, 0.0F);
+      } else {
+        std::copy(input + q * in, input + (q + 1) * in, dst);
+      }
+    }
+    float* y = output + p * out;
+    // the residual may alias the output, read it before the row is written
+    if (residual != nullptr) {
+      const float* r = residual + p * out;
+      for (int o = 0; o < out; ++o) y[o] = layer.bias[o] + r[o];
+    } else {
+      std::copy(layer.bias.begin(), layer.bias.end(), y);
+    }
+    gemv(column.data(), layer.in_size, layer.weight.data(), out, y);
+    relu(y, out);
+  }
+}
+
+void NativeModel::forward(const float* input, int batch, float* policy,
+                          float* value) const {
+  const int cells = height * width;
+  const int max_channels = std::max(in_channels, channels);
+  // scratch buffers are reused by every inference thread
+  thread_local std::vector<float> column, x, a, b, head, hidden;
+  column.resize(9 * max_channels);
+  x.resize(cells * in_channels);
+  a.resize(cells * channels);
+  b.resize(cells * channels);
+  head.resize(2 * cells);
+  hidden.resize(channels);
+
+  for (int n = 0; n < batch; ++n) {
+    // NCHW -> channels-last
+    const float* sample = input + n * in_channels * cells;
+    for (int c = 0; c < in_channels; ++c)
+      for (int p = 0; p < cells; ++p)
+        x[p * in_channels + c] = sample[c * cells + p];
+
+    // backbone
+    conv3x3(stem, x.data(), a.data(), nullptr, column);
+    for (int i = 0; i < blocks; ++i) {
+      conv3x3(convs[2 * i], a.data(), b.data(), nullptr, column);
+      conv3x3(convs[2 * i + 1], b.data(), a.data(), a.data(), column);
+    }
+
+    // policy head
+    float* p = policy + n * num_actions;
+    conv1x1(a.data(), cells, channels, policy_conv.weight, policy_conv.bias,
+            head.data());
+    linear(head.data(), 2 * cells, policy_fc.weight, policy_fc.bias, p);
+    const float max_logit = *std::max_element(p, p + num_actions);
+    float sum = 0.0F;
+    for (int i = 0; i < num_actions; ++i) {
+      p[i] = std::exp(p[i] - max_logit);
+      sum += p[i];
+    }
+    for (int i = 0; i < num_actions; ++i) p[i] /= sum;
+
+    // value head
+    float* v = value + n * num_players;
+    conv1x1(a.data(), cells, channels, value_conv.weight, value_conv.bias,
+            head.data());
+    linear(head.data(), cells, value_fc1.weight, value_fc1.bias,
+           hidden.data());
+    relu(hidden.data(), channels);
+    linear(hidden.data(), channels, value_fc2.weight, value_fc2.bias, v);
+    for (int i = 0; i < num_players; ++i) v[i] = std::tanh(v[i]);
+  }
+}
+
+}  // namespace clap::mcts
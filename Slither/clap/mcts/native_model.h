@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clap::mcts {
+
+// Self-contained CPU forward pass of clap.nn.AlphaZero with a ResNet backbone.
+// Weights are exported by clap.nn.export_native with batch norms folded into
+// the convolutions; activations are kept channels-last so every 3x3
+// convolution becomes a (9 * in_channels) x channels GEMV per board cell.
+class NativeModel {
+ public:
+  static constexpr uint32_t kMagic = 0x4e4e4c43;  // "CLNN"
+  static constexpr uint32_t kVersion = 1;
+
+  static std::shared_ptr<NativeModel> load(const std::string& path);
+
+  // input: (batch, in_channels, height, width)
+  // policy: (batch, num_actions), value: (batch, num_players)
+  void forward(const float* input, int batch, float* policy,
+               float* value) const;
+
+  int policy_size() const { return num_actions; }
+  int value_size() const { return num_players; }
+
+ private:
+  struct Layer {
+    int in_size;
+    int out_size;
+    // 3x3 conv: (9, in_channels, out_channels); linear: (in, out);
+    // 1x1 conv: (out_channels, in_channels)
+    std::vector<float> weight;
+    std::vector<float> bias;
+  };
+
+  void read_layer(std::istream& in, Layer& layer, int in_size, int out_size);
+  void conv3x3(const Layer& layer, const float* input, float* output,
+               const float* residual, std::vector<float>& column) const;
+
+  int in_channels, height, width, channels, blocks;
+  int num_actions, num_players;
+  // neighbours[cell * 9 + k], -1 for the zero padding
+  std::vector<int> neighbours;
+
+  Layer stem;
+  // conv1, conv2 of every residual block
+  std::vector<Layer> convs;
+  Layer policy_conv, policy_fc;
+  Layer value_conv, value_fc1, value_fc2;
+};
+
+}  // namespace clap::mcts
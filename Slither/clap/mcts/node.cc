@@ -5,6 +5,7 @@
 #include <iostream>
 
 #include "clap/mcts/engine.h"
+#include "clap/mcts/engine_stats.h"
 #include "clap/mcts/job.h"
 #include "clap/mcts/tree.h"
 
@@ -54,6 +55,7 @@ std::tuple<game::Action, Node*> Node::select(std::mt19937& rng) const {
 }
 
 void Node::expand(const std::vector<game::Action>& legal_actions) {
+  EngineStats::add(EngineStats::kExpansions);
   children.reserve(legal_actions.size());
   for (const auto& action : legal_actions)
     children.emplace_back(0.0F, action, Node{});
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <optional>
+#include <type_traits>
+
+#include "clap/game/game.h"
+
+namespace clap::mcts {
+
+// A state of a search job (BasicJob, vl::BasicJob). A concrete (final) state
+// type is kept by value, so copies reuse its buffers and its calls are direct;
+// game::State itself is abstract and stays behind a StatePtr.
+template <class StateT, bool = std::is_abstract_v<StateT>>
+class StateHolder {
+ public:
+  StateHolder() = default;
+  StateHolder(game::StatePtr state)  // NOLINT
+      : state(static_cast<const StateT&>(*state)) {}
+
+  StateT& operator*() { return *state; }
+  const StateT& operator*() const { return *state; }
+  StateT* operator->() { return &*state; }
+  const StateT* operator->() const { return &*state; }
+
+ private:
+  std::optional<StateT> state;
+};
+
+template <class StateT>
+class StateHolder<StateT, true> {
+ public:
+  StateHolder() = default;
+  StateHolder(game::StatePtr state) : state(std::move(state)) {}  // NOLINT
+  StateHolder(const StateHolder& other)
+      : state(other.state ? other.state->clone() : nullptr) {}
+  StateHolder(StateHolder&&) = default;
+  StateHolder& operator=(const StateHolder& other) {
+    state = other.state ? other.state->clone() : nullptr;
+    return *this;
+  }
+  StateHolder& operator=(StateHolder&&) = default;
+
+  StateT& operator*() { return *state; }
+  const StateT& operator*() const { return *state; }
+  StateT* operator->() { return state.get(); }
+  const StateT* operator->() const { return state.get(); }
+
+ private:
+  game::StatePtr state;
+};
+
+}  // namespace clap::mcts
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace clap::mcts {
+
+// Blocks of per-thread state owned by one engine. A worker attaches to the
+// engine it runs for and is the only writer of its block; on detach the block
+// goes back to the pool, contents kept, and the next thread to attach reuses
+// it, so an engine holds as many blocks as it ever ran threads at once.
+template <class Block>
+class ThreadBlocks {
+ public:
+  Block* acquire() {
+    std::lock_guard lock(mutex);
+    if (free.empty()) {
+      blocks.push_back(std::make_unique<Block>());
+      return blocks.back().get();
+    }
+    Block* block = free.back();
+    free.pop_back();
+    return block;
+  }
+  void release(Block* block) {
+    std::lock_guard lock(mutex);
+    free.push_back(block);
+  }
+  template <class Visit>
+  void for_each(Visit visit) const {
+    std::lock_guard lock(mutex);
+    for (const auto& block : blocks) visit(std::as_const(*block));
+  }
+  template <class Visit>
+  void for_each(Visit visit) {
+    std::lock_guard lock(mutex);
+    for (auto& block : blocks) visit(*block);
+  }
+
+ private:
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<Block>> blocks;
+  std::vector<Block*> free;
+};
+
+}  // namespace clap::mcts
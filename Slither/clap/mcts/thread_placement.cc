@@ -0,0 +1,189 @@
+#include "clap/mcts/thread_placement.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace clap::mcts {
+
+namespace {
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}, also used for node lists
+std::vector<int> parse_cpulist(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    const auto dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+#ifdef __linux__
+// from <numaif.h>, which needs libnuma headers
+constexpr int kMpolDefault = 0;
+constexpr int kMpolInterleave = 3;
+#endif
+
+}  // namespace
+
+std::vector<std::vector<int>> ThreadPlacement::numa_nodes() {
+  std::vector<std::vector<int>> nodes;
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string list;
+  if (online && std::getline(online, list)) {
+    // indexed by node id; memory-only nodes keep an empty cpu list
+    for (const int node : parse_cpulist(list)) {
+      if (static_cast<size_t>(node) >= nodes.size()) nodes.resize(node + 1);
+      std::ifstream file("/sys/devices/system/node/node" +
+                         std::to_string(node) + "/cpulist");
+      if (file && std::getline(file, list)) nodes[node] = parse_cpulist(list);
+    }
+  }
+  const bool has_cpus =
+      std::any_of(nodes.begin(), nodes.end(),
+                  [](const auto& cpus) { return !cpus.empty(); });
+  if (!has_cpus) {
+    nodes.assign(1, std::vector<int>(
+                        std::max(1U, std::thread::hardware_concurrency())));
+    auto& cpus = nodes.back();
+    for (size_t i = 0; i < cpus.size(); ++i) cpus[i] = i;
+  }
+  return nodes;
+}
+
+void ThreadPlacement::reset(int cpu_workers, int gpu_workers,
+                            const std::vector<int>& cpu_cores,
+                            const std::vector<int>& gpu_cores,
+                            bool automatic) {
+  nodes = numa_nodes();
+  cpu_plan.assign(cpu_workers, -1);
+  gpu_plan.assign(gpu_workers, -1);
+  slots.clear();
+
+  if (automatic) {
+    // inference workers take the last free core of each node in turn
+    auto free_cpus = nodes;
+    for (int i = 0; i < gpu_workers; ++i) {
+      // keep at least one core of each node for the cpu workers
+      auto& cpus = free_cpus[i % free_cpus.size()];
+      if (cpus.size() <= 1) continue;
+      gpu_plan[i] = cpus.back();
+      cpus.pop_back();
+    }
+    std::vector<int> order;
+    for (const auto& cpus : free_cpus)
+      order.insert(order.end(), cpus.begin(), cpus.end());
+    // contiguous blocks: neighbouring worker ids (and steal victims) share a
+    // node while every node gets a share of the workers
+    for (int i = 0; i < cpu_workers; ++i) {
+      cpu_plan[i] = static_cast<size_t>(cpu_workers) <= order.size()
+                        ? order[static_cast<size_t>(i) * order.size() /
+                                cpu_workers]
+                        : order[i % order.size()];
+    }
+  }
+  if (!cpu_cores.empty()) {
+    for (int i = 0; i < cpu_workers; ++i)
+      cpu_plan[i] = cpu_cores[i % cpu_cores.size()];
+  }
+  if (!gpu_cores.empty()) {
+    for (int i = 0; i < gpu_workers; ++i)
+      gpu_plan[i] = gpu_cores[i % gpu_cores.size()];
+  }
+}
+
+void ThreadPlacement::place(std::thread& thread, const std::string& role,
+                            int index) {
+  std::vector<int> cpus;
+  if (role == "cpu") {
+    if (static_cast<size_t>(index) < cpu_plan.size() && cpu_plan[index] >= 0)
+      cpus.push_back(cpu_plan[index]);
+  } else if (static_cast<size_t>(index) < gpu_plan.size() &&
+             gpu_plan[index] >= 0) {
+    if (role == "gpu") {
+      cpus.push_back(gpu_plan[index]);
+    } else {
+      // pipeline helpers float over the node of their inference worker
+      const int node = node_of({gpu_plan[index]});
+      if (node >= 0) cpus = nodes[node];
+    }
+  }
+
+#ifdef __linux__
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0)
+      cpus.clear();
+  }
+#else
+  cpus.clear();
+#endif
+  slots.push_back({role, index, cpus, node_of(cpus)});
+}
+
+int ThreadPlacement::node_of(const std::vector<int>& cpus) const {
+  int found = -1;
+  for (const int cpu : cpus) {
+    int node = -1;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+      if (std::find(nodes[n].begin(), nodes[n].end(), cpu) != nodes[n].end())
+        node = n;
+    }
+    if (node < 0 || (found >= 0 && node != found)) return -1;
+    found = node;
+  }
+  return found;
+}
+
+std::string ThreadPlacement::report() const {
+  std::stringstream ss;
+  ss << nodes.size() << " NUMA node(s)" << std::endl;
+  for (const auto& slot : slots) {
+    ss << slot.role << "[" << slot.index << "]: ";
+    if (slot.cpus.empty()) {
+      ss << "unpinned" << std::endl;
+      continue;
+    }
+    ss << "cpu";
+    for (const int cpu : slot.cpus) ss << " " << cpu;
+    ss << ", node " << slot.node << std::endl;
+  }
+  return ss.str();
+}
+
+bool ThreadPlacement::set_interleave(bool enable) {
+#ifdef __linux__
+  // only nodes with memory may be in the mask
+  std::ifstream file("/sys/devices/system/node/has_memory");
+  std::string list;
+  if (enable && !(file && std::getline(file, list))) return false;
+  unsigned long mask = 0;  // NOLINT(runtime/int)
+  for (const int node : parse_cpulist(list)) {
+    if (static_cast<size_t>(node) < 8 * sizeof(mask)) mask |= 1UL << node;
+  }
+  const long status =  // NOLINT(runtime/int)
+      enable ? syscall(SYS_set_mempolicy, kMpolInterleave, &mask,
+                       8 * sizeof(mask))
+             : syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0);
+  return status == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace clap::mcts
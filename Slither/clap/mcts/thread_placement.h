@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clap::mcts {
+
+// Pins engine threads to cores and records the resulting layout.
+// Linux only; elsewhere threads are left where the OS puts them.
+class ThreadPlacement {
+ public:
+  struct Slot {
+    std::string role;
+    int index;
+    // empty if the thread is not pinned
+    std::vector<int> cpus;
+    // NUMA node of the cpus, -1 if unknown or mixed
+    int node;
+  };
+
+  ThreadPlacement() = default;
+
+  // Explicit core lists win over the automatic plan, which keeps neighbouring
+  // cpu workers on one node, spreads the blocks over all nodes and reserves
+  // the last cores of each node for inference workers.
+  void reset(int cpu_workers, int gpu_workers,
+             const std::vector<int>& cpu_cores,
+             const std::vector<int>& gpu_cores, bool automatic);
+  // role: "cpu", "gpu", or "batch" / "scatter" which share the node of the
+  // inference worker with the same index
+  void place(std::thread& thread, const std::string& role, int index);
+  const std::vector<Slot>& layout() const { return slots; }
+  std::string report() const;
+
+  // Interleave the pages of the calling thread, and of the threads it
+  // creates from now on, over all nodes with memory instead of first touch.
+  // Returns false if the kernel refused.
+  static bool set_interleave(bool enable);
+
+  // logical cpus of every NUMA node, one node holding every cpu if the
+  // topology cannot be read
+  static std::vector<std::vector<int>> numa_nodes();
+
+  ~ThreadPlacement() = default;
+
+ private:
+  int node_of(const std::vector<int>& cpus) const;
+
+  std::vector<std::vector<int>> nodes;
+  std::vector<int> cpu_plan;
+  std::vector<int> gpu_plan;
+  std::vector<Slot> slots;
+};
+
+}  // namespace clap::mcts
@@ -0,0 +1,103 @@
+#include "clap/mcts/tracer.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace clap::mcts {
+
+void Tracer::enable(int events_per_thread) {
+  capacity = events_per_thread;
+  epoch = Clock::now();
+  buffers.for_each([&](Buffer& buffer) {
+    buffer.epoch = epoch;
+    buffer.count = 0;
+    buffer.events.assign(capacity, Event{});
+  });
+  is_enabled = true;
+}
+
+Tracer::Buffer* Tracer::attach(const std::string& name) {
+  Buffer* buffer = buffers.acquire();
+  buffer->name = name;
+  // a new buffer, enable() sized the others
+  if (buffer->events.empty()) {
+    buffer->epoch = epoch;
+    buffer->events.resize(capacity);
+  }
+  return buffer;
+}
+
+void Tracer::record(const char* name, Clock::time_point begin,
+                    Clock::time_point end) {
+  if (current == nullptr) return;
+  push({name, 0, since_epoch(begin), since_epoch(end)});
+}
+
+void Tracer::record_async(const char* name, uint64_t id,
+                          Clock::time_point begin, Clock::time_point end) {
+  if (current == nullptr) return;
+  push({name, id, since_epoch(begin), since_epoch(end)});
+}
+
+void Tracer::push(const Event& event) {
+  auto& buffer = *current;
+  if (buffer.events.empty()) return;
+  buffer.events[buffer.count % buffer.events.size()] = event;
+  ++buffer.count;
+}
+
+int64_t Tracer::since_epoch(Clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time -
+                                                              current->epoch)
+      .count();
+}
+
+bool Tracer::write(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file) return false;
+
+  file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first = true;
+  const auto separator = [&]() -> std::ofstream& {
+    if (!first) file << ",\n";
+    first = false;
+    return file;
+  };
+
+  // buffers are numbered in the order the engine created them
+  int tid = 0;
+  buffers.for_each([&](const Buffer& buffer) {
+    ++tid;
+    if (buffer.count == 0) return;
+    separator() << R"({"name":"thread_name","ph":"M","pid":0,"tid":)"
+                << tid << R"(,"args":{"name":")" << buffer.name
+                << "\"}}";
+
+    const uint64_t size = buffer.events.size();
+    const uint64_t first_event =
+        buffer.count > size ? buffer.count - size : 0;
+    for (uint64_t i = first_event; i < buffer.count; ++i) {
+      const auto& event = buffer.events[i % size];
+      const double ts = event.begin_ns / 1000.0;
+      const double end = event.end_ns / 1000.0;
+      if (event.id == 0) {
+        separator() << R"({"name":")" << event.name
+                    << R"(","cat":"clap","ph":"X","pid":0,"tid":)"
+                    << tid << ",\"ts\":" << ts
+                    << ",\"dur\":" << end - ts << "}";
+      } else {
+        for (const auto& [phase, time] : {std::pair{'b', ts}, {'e', end}}) {
+          separator() << R"({"name":")" << event.name
+                      << R"(","cat":"job","ph":")" << phase
+                      << R"(","pid":0,"tid":)" << tid
+                      << ",\"id\":\"0x" << std::hex << event.id << std::dec
+                      << "\",\"ts\":" << time << "}";
+        }
+      }
+    }
+  });
+  file << "]}" << std::endl;
+  return static_cast<bool>(file);
+}
+
+}  // namespace clap::mcts
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "clap/mcts/thread_blocks.h"
+
+namespace clap::mcts {
+
+// Opt-in Chrome / Perfetto trace of the search pipeline of one engine.
+// Every worker attaches to its engine's tracer and records into its own ring
+// buffer, keeping the most recent events; write() dumps all buffers as trace
+// event JSON once the workers are joined. Buffers are reused by the workers
+// of later runs. On a thread that is not attached a scope costs one
+// thread-local load.
+class Tracer {
+ private:
+  struct Buffer;
+
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // records the calling thread into `tracer` under `name` while it lives,
+  // when the tracer is enabled
+  class Thread {
+   public:
+    Thread(Tracer& tracer, const std::string& name)
+        : tracer(tracer),
+          previous(current),
+          buffer(tracer.is_enabled ? tracer.attach(name) : nullptr) {
+      current = buffer;
+    }
+    ~Thread() {
+      current = previous;
+      if (buffer) tracer.buffers.release(buffer);
+    }
+    Thread(const Thread&) = delete;
+    Thread& operator=(const Thread&) = delete;
+
+   private:
+    Tracer& tracer;
+    Buffer* previous;
+    Buffer* buffer;
+  };
+
+  // names must be string literals, events only keep the pointer
+  class Scope {
+   public:
+    explicit Scope(const char* name)
+        : name(Tracer::recording() ? name : nullptr),
+          begin(this->name != nullptr ? Clock::now() : Clock::time_point()) {
+    }
+    ~Scope() {
+      if (name != nullptr) Tracer::record(name, begin, Clock::now());
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    const char* name;
+    Clock::time_point begin;
+  };
+
+  // whether the calling thread records into an engine's trace
+  static bool recording() { return current != nullptr; }
+  bool enabled() const { return is_enabled; }
+  // for the workers that attach from now on, drops the events of a previous
+  // run; call it while no worker is attached
+  void enable(int events_per_thread = kDefaultCapacity);
+  void disable() { is_enabled = false; }
+
+  // complete event on the calling thread
+  static void record(const char* name, Clock::time_point begin,
+                     Clock::time_point end);
+  // async span, may begin and end on different threads (e.g. a job waiting
+  // for inference); id pairs them up
+  static void record_async(const char* name, uint64_t id,
+                           Clock::time_point begin, Clock::time_point end);
+
+  bool write(const std::string& path) const;
+
+  static constexpr int kDefaultCapacity = 1 << 16;
+
+ private:
+  struct Event {
+    const char* name;
+    // 0 for complete events
+    uint64_t id;
+    int64_t begin_ns;
+    int64_t end_ns;
+  };
+  struct Buffer {
+    // name of the last thread that attached
+    std::string name;
+    Clock::time_point epoch;
+    // total events recorded, the ring keeps the last events.size()
+    uint64_t count = 0;
+    std::vector<Event> events;
+  };
+
+  Buffer* attach(const std::string& name);
+  static void push(const Event& event);
+  // relative to the epoch of the calling thread's tracer
+  static int64_t since_epoch(Clock::time_point time);
+
+  static inline thread_local Buffer* current = nullptr;
+  bool is_enabled = false;
+  int capacity = kDefaultCapacity;
+  Clock::time_point epoch = Clock::now();
+  // each buffer is 2 MB at the default capacity
+  ThreadBlocks<Buffer> buffers;
+};
+
+}  // namespace clap::mcts
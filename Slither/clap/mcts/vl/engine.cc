@@ -3,34 +3,60 @@
 #include <torch/torch.h>
 
 #include <algorithm>
+#include <deque>
+#include <iostream>
+#include <numeric>
 #include <random>
+#include <stdexcept>
+#include <type_traits>
+
+#include "clap/game/slither/slither.h"
 
 namespace clap::mcts::vl {
 
-int Engine::batch_size;
-int Engine::max_simulations;
-
-float Engine::c_puct;
-float Engine::dirichlet_alpha;
-float Engine::dirichlet_epsilon;
-float Engine::float_error = 1e-3;
-
-int Engine::temperature_drop = std::numeric_limits<int>::max();
-int Engine::num_sampled_transformations = 0;
-int Engine::batch_per_job = 1;
-int Engine::inference_wait_ms = 1;
-int Engine::virtual_loss = 3;
-
-bool Engine::play_until_terminal = true;
-bool Engine::auto_reset_job = true;
-bool Engine::play_until_turn_player = false;
-bool Engine::mcts_until_turn_player = false;
-bool Engine::verbose = false;
-int Engine::top_n_childs = 10;
-bool Engine::states_value_using_childs = false;
-bool Engine::dump_tree = true;
-
-Engine::Engine(const std::vector<int>& gpus, int models)
+int EngineConfig::batch_size;
+int EngineConfig::max_simulations;
+
+float EngineConfig::c_puct;
+float EngineConfig::dirichlet_alpha;
+float EngineConfig::dirichlet_epsilon;
+float EngineConfig::float_error = 1e-3;
+
+int EngineConfig::temperature_drop = std::numeric_limits<int>::max();
+int EngineConfig::num_sampled_transformations = 0;
+int EngineConfig::batch_per_job = 1;
+int EngineConfig::inference_wait_ms = 1;
+bool EngineConfig::adaptive_batching = false;
+bool EngineConfig::pipelined_inference = false;
+bool EngineConfig::optimize_model = false;
+bool EngineConfig::warmup_model = false;
+bool EngineConfig::native_inference = false;
+std::vector<int> EngineConfig::cpu_worker_cores;
+std::vector<int> EngineConfig::gpu_worker_cores;
+bool EngineConfig::auto_affinity = false;
+bool EngineConfig::numa_interleave = false;
+int EngineConfig::stats_interval_ms = 0;
+std::string EngineConfig::trace_path;
+bool EngineConfig::phase_histograms = false;
+bool EngineConfig::stub_inference = false;
+int EngineConfig::stub_latency_us = 0;
+bool EngineConfig::deterministic = false;
+uint32_t EngineConfig::seed = 0;
+bool EngineConfig::tactical_oracle = false;
+size_t EngineConfig::cache_entries = 1 << 20;
+int EngineConfig::virtual_loss = 3;
+
+bool EngineConfig::play_until_terminal = true;
+bool EngineConfig::auto_reset_job = true;
+bool EngineConfig::play_until_turn_player = false;
+bool EngineConfig::mcts_until_turn_player = false;
+bool EngineConfig::verbose = false;
+int EngineConfig::top_n_childs = 10;
+bool EngineConfig::states_value_using_childs = false;
+bool EngineConfig::dump_tree = true;
+
+template <class StateT>
+BasicEngine<StateT>::BasicEngine(const std::vector<int>& gpus, int models)
     : running(false),
       gpus(gpus),
       model_manager(gpus, models),
@@ -43,51 +69,143 @@ Engine::Engine(const std::vector<int>& gpus, int models)
   }
 }
 
-void Engine::load_game(const std::string& name) {
+template <class StateT>
+void BasicEngine<StateT>::load_game(const std::string& name) {
   game = clap::game::load(name);
+  if constexpr (!std::is_abstract_v<StateT>) {
+    if (dynamic_cast<StateT*>(game->new_initial_state().get()) == nullptr)
+      throw std::invalid_argument("game " + name +
+                                  " does not match the engine's state type");
+  }
 }
 
-void Engine::load_model(const std::string& path, int version) {
-  model_manager.load(path, version);
+template <class StateT>
+void BasicEngine<StateT>::load_model(const std::string& path, int version) {
+  if (Engine::stub_inference) return;
+  if (Engine::native_inference) {
+    model_manager.load_native(path, version);
+    return;
+  }
+
+  std::vector<int64_t> warmup_shape;
+  if (Engine::warmup_model) {
+    const auto& observation_tensor_shape = game->observation_tensor_shape();
+    warmup_shape.assign(observation_tensor_shape.begin(),
+                        observation_tensor_shape.end());
+    warmup_shape.insert(warmup_shape.begin(),
+                        Engine::batch_size * Engine::batch_per_job);
+  }
+  model_manager.load(path, version, Engine::optimize_model, warmup_shape);
 }
 
-void Engine::start(int cpu_workers, int gpu_workers, int num_envs) {
+template <class StateT>
+void BasicEngine<StateT>::start(int cpu_workers, int gpu_workers,
+                                int num_envs) {
   if (running) return;
   running = true;
 
+  // before any worker starts, they attach to the trace when it is enabled
+  if (!Engine::trace_path.empty()) tracer.enable();
+  // counts of this run only, before any worker adds to them
+  stats.reset();
+  histograms.reset();
+  histograms.enable(Engine::phase_histograms);
+
+  thread_placement.reset(cpu_workers, gpu_workers, Engine::cpu_worker_cores,
+                         Engine::gpu_worker_cores, Engine::auto_affinity);
+  // spawned threads inherit the memory policy of this thread, otherwise
+  // pinned workers first-touch their tree nodes on their own node
+  if (Engine::numa_interleave) ThreadPlacement::set_interleave(true);
+
+  // worker seeds follow Engine::seed when it is fixed
   std::random_device rd;
+  std::mt19937 seeder(Engine::deterministic || Engine::seed != 0 ? Engine::seed
+                                                                 : rd());
+
+  // tactical checks of a position run once for all jobs and searches
+  game->set_cache_entries(Engine::cache_entries);
+
+  // create a vector containing all transformations
+  transformations.resize(game->num_transformations());
+  std::iota(transformations.begin(), transformations.end(), 0);
+
   cpu_threads.reserve(cpu_workers);
-  for (int i = 0; i < cpu_workers; ++i) {
-    auto seed = rd();
-    cpu_threads.emplace_back(&Engine::cpu_worker, this, seed);
+  cpu_jobs.reset(Engine::deterministic ? 1 : cpu_workers);
+  for (int i = 0; i < cpu_workers && !Engine::deterministic; ++i) {
+    auto seed = seeder();
+    cpu_threads.emplace_back(&BasicEngine::cpu_worker, this, i, seed);
+    thread_placement.place(cpu_threads.back(), "cpu", i);
   }
 
+  batch_controller.reset(Engine::batch_size,
+                         std::chrono::milliseconds(Engine::inference_wait_ms),
+                         gpu_workers);
+
   gpu_threads.reserve(gpu_workers);
-  for (int i = 0; i < gpu_workers; ++i) {
-    auto seed = rd();
-    gpu_threads.emplace_back(&Engine::gpu_worker, this, seed);
+  for (int i = 0; i < gpu_workers && !Engine::deterministic; ++i) {
+    auto seed = seeder();
+    if (Engine::pipelined_inference) {
+      // two batches per inference worker: one in flight, one being built
+      for (int b = 0; b < 2; ++b)
+        free_batches.enqueue(std::make_unique<Batch>());
+      batch_threads.emplace_back(&BasicEngine::batch_worker, this, seed);
+      gpu_threads.emplace_back(&BasicEngine::inference_worker, this);
+      scatter_threads.emplace_back(&BasicEngine::scatter_worker, this);
+      thread_placement.place(batch_threads.back(), "batch", i);
+      thread_placement.place(scatter_threads.back(), "scatter", i);
+    } else {
+      gpu_threads.emplace_back(&BasicEngine::gpu_worker, this, seed);
+    }
+    thread_placement.place(gpu_threads.back(), "gpu", i);
   }
 
   if (num_envs < 0) num_envs = 2 * Engine::batch_size * gpu_workers;
   for (int i = 0; i < num_envs; ++i)
     cpu_jobs.enqueue(std::make_unique<Job>(this));
+  // after the initial jobs, so the first batch does not depend on timing
+  if (Engine::deterministic) {
+    cpu_threads.emplace_back(&BasicEngine::deterministic_worker, this,
+                             seeder());
+    thread_placement.place(cpu_threads.back(), "cpu", 0);
+  }
+
+  if (Engine::numa_interleave) ThreadPlacement::set_interleave(false);
+  if (Engine::verbose) std::cerr << thread_placement.report();
+
+  if (Engine::stats_interval_ms > 0)
+    stats_reporter.start(stats,
+                         std::chrono::milliseconds(Engine::stats_interval_ms));
 }
 
-void Engine::stop() {
+template <class StateT>
+void BasicEngine<StateT>::stop() {
   if (!running) return;
   running = false;
 
   for (const auto& thread : cpu_threads) cpu_jobs.enqueue(nullptr);
 
   for (auto& thread : cpu_threads) thread.join();
+  for (auto& thread : batch_threads) thread.join();
   for (auto& thread : gpu_threads) thread.join();
+  for (auto& thread : scatter_threads) thread.join();
+  stats_reporter.stop();
+
+  if (tracer.enabled()) {
+    tracer.disable();
+    if (!tracer.write(Engine::trace_path))
+      std::cerr << "failed to write trace " << Engine::trace_path << std::endl;
+  }
 
   // enqueue a empty string to unblock Engine::get_trajectory
   trajectories.enqueue("");
 }
 
-void Engine::add_job(int num, const std::string& serialize_string) {
+template <class StateT>
+void BasicEngine<StateT>::add_job(int num,
+                                  const std::string& serialize_string) {
   if (num < 1) return;
+  // the deterministic worker takes the jobs of one call together
+  std::lock_guard lock(add_job_mutex);
   auto first_job = std::make_unique<Job>(this, serialize_string);
   auto root = first_job->tree.root_node;
   cpu_jobs.enqueue(std::move(first_job));
@@ -99,166 +217,404 @@ void Engine::add_job(int num, const std::string& serialize_string) {
   }
 }
 
-std::string Engine::get_trajectory() {
+template <class StateT>
+std::string BasicEngine<StateT>::get_trajectory() {
   std::string raw;
   trajectories.wait_dequeue(raw);
   return raw;
 }
 
-void Engine::cpu_worker(uint32_t seed) {
+template <class StateT>
+void BasicEngine<StateT>::cpu_worker(int id, uint32_t seed) {
+  const Tracer::Thread tracing(tracer, "cpu_worker " + std::to_string(id));
+  const EngineStats::Scope counting(stats);
+  const PhaseHistograms::Scope timing(histograms);
   std::mt19937 rng{seed};
   while (running) {
     std::unique_ptr<Job> job;
-    cpu_jobs.wait_dequeue(job);
+    const auto wait_start = std::chrono::steady_clock::now();
+    cpu_jobs.wait_dequeue(id, job);
+    EngineStats::add(EngineStats::kQueueWaits);
+    EngineStats::add(EngineStats::kQueueWaitUs,
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - wait_start)
+                         .count());
     if (job == nullptr) return;
-    // std::cout<<job->tree.root_node.use_count()<<std::endl;
-
-    while (true) {
-      switch (job->next_step) {
-        case Job::Step::SELECT:
-          job->select(rng);
-          break;
-        case Job::Step::UPDATE:
-          job->update(rng);
-          break;
-        case Job::Step::PLAY:
-          job->play(rng);
-          break;
-        case Job::Step::REPORT:
-          job->report();
-          break;
-        default:
-          goto done;
-      }
-    }
+    step_job(*job, rng);
 
-  done:
     if (job->next_step == Job::Step::EVALUATE) {
+      if (Engine::adaptive_batching) batch_controller.record_arrival();
+      job->worker = id;
+      job->evaluate_begin = std::chrono::steady_clock::now();
       gpu_jobs[job->root_state->current_player() % num_models].enqueue(
           std::move(job));
     }
   }
 }
 
-void Engine::gpu_worker(uint32_t seed) {
+template <class StateT>
+void BasicEngine<StateT>::deterministic_worker(uint32_t seed) {
+  const Tracer::Thread tracing(tracer, "deterministic_worker");
+  const EngineStats::Scope counting(stats);
+  const PhaseHistograms::Scope timing(histograms);
   std::mt19937 rng{seed};
-  const auto wait_time = std::chrono::milliseconds(Engine::inference_wait_ms);
+  std::deque<std::unique_ptr<Job>> jobs;
+  std::vector<Batch> batches(num_models);
+  while (running) {
+    // an idle search waits for add_job, which queues a group as a whole
+    if (jobs.empty()) {
+      std::unique_ptr<Job> job;
+      cpu_jobs.wait_dequeue(0, job);
+      if (job == nullptr) return;
+      jobs.push_back(std::move(job));
+    }
+    {
+      std::lock_guard lock(add_job_mutex);
+      std::unique_ptr<Job> job;
+      while (cpu_jobs.try_wait_dequeue(0, job)) {
+        if (job == nullptr) return;
+        jobs.push_back(std::move(job));
+      }
+    }
 
-  const auto& observation_tensor_shape = game->observation_tensor_shape();
-  std::vector<int64_t> input_shape(observation_tensor_shape.begin(),
-                                   observation_tensor_shape.end());
-  // add batch dimension (CHW -> BCHW)
-  input_shape.insert(input_shape.begin(), 1);
+    // step jobs in queue order until a batch is full
+    std::vector<std::unique_ptr<Job>> deferred;
+    int pending = 0;
+    while (!jobs.empty() && pending < Engine::batch_size) {
+      auto job = std::move(jobs.front());
+      jobs.pop_front();
+      // the node it waited for may be expanded by now
+      if (job->next_step == Job::Step::BLOCKED)
+        job->next_step = Job::Step::SELECT;
+      step_job(*job, rng);
+      if (job->next_step == Job::Step::EVALUATE) {
+        job->evaluate_begin = std::chrono::steady_clock::now();
+        const int model = job->root_state->current_player() % num_models;
+        batches[model].jobs.push_back(std::move(job));
+        ++pending;
+      } else if (job->next_step != Job::Step::DONE) {
+        deferred.push_back(std::move(job));
+      }
+    }
 
-  // create a vector containing all transformations
-  int num_transformations = game->num_transformations();
-  std::vector<int> transformations;
-  transformations.reserve(num_transformations);
-  for (int i = 0; i < num_transformations; ++i) transformations.push_back(i);
+    // evaluated jobs resume in batch order, then the ones that had to wait
+    for (int model = 0; model < num_models; ++model) {
+      auto& batch = batches[model];
+      if (batch.jobs.empty()) continue;
+      batch.model = model;
+      assemble_batch(batch, rng);
+      forward_batch(batch);
+      scatter_batch(batch);
+      for (auto& job : batch.jobs) jobs.push_back(std::move(job));
+      batch.jobs.clear();
+    }
+    for (auto& job : deferred) jobs.push_back(std::move(job));
+  }
+}
+
+template <class StateT>
+void BasicEngine<StateT>::step_job(Job& job, std::mt19937& rng) {
+  while (true) {
+    switch (job.next_step) {
+      case Job::Step::SELECT: {
+        Tracer::Scope scope("SELECT");
+        {
+          PhaseHistograms::Timer timer(PhaseHistograms::kSelectNs);
+          job.select(rng);
+        }
+        PhaseHistograms::record(PhaseHistograms::kSelectDepth,
+                                job.selection_path.size());
+        break;
+      }
+      case Job::Step::UPDATE: {
+        Tracer::Scope scope("UPDATE");
+        PhaseHistograms::Timer timer(PhaseHistograms::kUpdateNs);
+        job.update(rng);
+        break;
+      }
+      case Job::Step::PLAY: {
+        // play() waits for the other jobs of the tree to let go of it, which
+        // they cannot while the deterministic worker is waiting here
+        if (Engine::deterministic && job.tree.root_node.use_count() != 1)
+          return;
+        Tracer::Scope scope("PLAY");
+        job.play(rng);
+        break;
+      }
+      case Job::Step::REPORT: {
+        Tracer::Scope scope("REPORT");
+        job.report();
+        break;
+      }
+      default:
+        return;
+    }
+  }
+}
+
+template <class StateT>
+void BasicEngine<StateT>::gpu_worker(uint32_t seed) {
+  const Tracer::Thread tracing(tracer, "gpu_worker");
+  const EngineStats::Scope counting(stats);
+  const PhaseHistograms::Scope timing(histograms);
+  std::mt19937 rng{seed};
+  Batch batch;
+  int gpu_job_toggle = 0;
+  while (running) {
+    if (!collect_batch(batch, rng, gpu_job_toggle)) continue;
+    forward_batch(batch);
+    scatter_batch(batch);
+  }
+}
 
+template <class StateT>
+void BasicEngine<StateT>::batch_worker(uint32_t seed) {
+  const Tracer::Thread tracing(tracer, "batch_worker");
+  const EngineStats::Scope counting(stats);
+  const PhaseHistograms::Scope timing(histograms);
+  std::mt19937 rng{seed};
   int gpu_job_toggle = 0;
   while (running) {
-    // collect jobs
-    std::chrono::steady_clock::time_point deadline;
-    std::chrono::system_clock::duration timeout = wait_time;
-    std::vector<std::unique_ptr<Job>> jobs;
-    jobs.reserve(Engine::batch_size);
-
-    while (jobs.size() < jobs.capacity() &&
-           timeout > std::chrono::steady_clock::duration::zero() && running) {
-      const int count = gpu_jobs[gpu_job_toggle].wait_dequeue_bulk_timed(
-          std::back_inserter(jobs), jobs.capacity() - jobs.size(), timeout);
-      // first dequeue or didn't get any job
-      if (count == jobs.size())
-        deadline = std::chrono::steady_clock::now() + wait_time;
-      if (jobs.empty()) gpu_job_toggle = (gpu_job_toggle + 1) % num_models;
-      timeout = deadline - std::chrono::steady_clock::now();
+    std::unique_ptr<Batch> batch;
+    if (!free_batches.wait_dequeue_timed(batch, kPipelinePollInterval))
+      continue;
+    if (collect_batch(*batch, rng, gpu_job_toggle)) {
+      ready_batches.enqueue(std::move(batch));
+    } else {
+      free_batches.enqueue(std::move(batch));
     }
-    if (jobs.empty()) continue;
-
-    // calculate input shape & size
-    const int batch_size = jobs.size() * Engine::batch_per_job;
-    input_shape[0] = batch_size;
-    const int input_size = std::accumulate(
-        input_shape.begin(), input_shape.end(), 1, std::multiplies<>());
-
-    std::vector<float> input_vector;
-    input_vector.reserve(input_size);
-    std::vector<std::vector<int>> batch_transformations;
-    batch_transformations.reserve(jobs.size());
-
-    // construct input tensor, record sampled transformations for each job
-    for (int i = 0; i < jobs.size(); ++i) {
-      std::vector<int> sampled_transformations;
-      if (Engine::num_sampled_transformations == 0) {
-        sampled_transformations.push_back(0);
-      } else {
-        std::sample(transformations.begin(), transformations.end(),
-                    std::back_inserter(sampled_transformations),
-                    Engine::num_sampled_transformations, rng);
-      }
-      batch_transformations.push_back(sampled_transformations);
-
-      for (int type : sampled_transformations) {
-        std::vector<float> transformed_observation =
-            game->transform_observation(jobs[i]->leaf_observation, type);
-        input_vector.insert(
-            input_vector.end(),
-            std::make_move_iterator(transformed_observation.begin()),
-            std::make_move_iterator(transformed_observation.end()));
-      }
+  }
+}
+
+template <class StateT>
+void BasicEngine<StateT>::inference_worker() {
+  const Tracer::Thread tracing(tracer, "inference_worker");
+  const EngineStats::Scope counting(stats);
+  const PhaseHistograms::Scope timing(histograms);
+  while (running) {
+    std::unique_ptr<Batch> batch;
+    if (!ready_batches.wait_dequeue_timed(batch, kPipelinePollInterval))
+      continue;
+    forward_batch(*batch);
+    done_batches.enqueue(std::move(batch));
+  }
+}
+
+template <class StateT>
+void BasicEngine<StateT>::scatter_worker() {
+  const Tracer::Thread tracing(tracer, "scatter_worker");
+  const EngineStats::Scope counting(stats);
+  const PhaseHistograms::Scope timing(histograms);
+  while (running) {
+    std::unique_ptr<Batch> batch;
+    if (!done_batches.wait_dequeue_timed(batch, kPipelinePollInterval))
+      continue;
+    scatter_batch(*batch);
+    free_batches.enqueue(std::move(batch));
+  }
+}
+
+template <class StateT>
+bool BasicEngine<StateT>::collect_batch(Batch& batch, std::mt19937& rng,
+                                        int& gpu_job_toggle) {
+  Tracer::Scope scope("collect_batch");
+  // batch cut-off & wait deadline
+  int max_jobs = Engine::batch_size;
+  std::chrono::microseconds wait_time =
+      std::chrono::milliseconds(Engine::inference_wait_ms);
+  if (Engine::adaptive_batching) {
+    std::tie(max_jobs, wait_time) = batch_controller.plan();
+  }
+
+  // collect jobs
+  std::chrono::steady_clock::time_point deadline;
+  std::chrono::steady_clock::time_point assembly_start;
+  std::chrono::system_clock::duration timeout = wait_time;
+  auto& jobs = batch.jobs;
+  jobs.clear();
+  jobs.reserve(max_jobs);
+
+  while (jobs.size() < max_jobs &&
+         timeout > std::chrono::steady_clock::duration::zero() && running) {
+    const int count = gpu_jobs[gpu_job_toggle].wait_dequeue_bulk_timed(
+        std::back_inserter(jobs), max_jobs - jobs.size(), timeout);
+    // first dequeue or didn't get any job
+    if (count == jobs.size())
+      deadline = std::chrono::steady_clock::now() + wait_time;
+    if (count > 0 && count == jobs.size())
+      assembly_start = std::chrono::steady_clock::now();
+    if (jobs.empty()) gpu_job_toggle = (gpu_job_toggle + 1) % num_models;
+    timeout = deadline - std::chrono::steady_clock::now();
+  }
+  if (jobs.empty()) return false;
+  if (PhaseHistograms::recording()) {
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& job : jobs) {
+      PhaseHistograms::record(PhaseHistograms::kInferenceQueueNs,
+                              now - job->evaluate_begin);
     }
-    auto [device, model_ptr] = model_manager.get(gpu_job_toggle);
-    auto input_tensor =
-        torch::from_blob(input_vector.data(), input_shape).to(device);
-
-    // inference
-    const auto results =
-        model_ptr->forward({input_tensor}).toTuple()->elements();
-    const auto batch_policy = results[0].toTensor().cpu().contiguous();
-    const auto batch_value = results[1].toTensor().cpu().contiguous();
-
-    const auto policy_size = batch_policy[0].numel();
-    const auto value_size = batch_value[0].numel();
-
-    auto policy_ptr_begin = batch_policy.data_ptr<float>();
-    auto value_ptr_begin = batch_value.data_ptr<float>();
-
-    std::vector<float> average_policy(policy_size);
-    std::vector<float> average_value(value_size);
-    // copy results back to jobs
-    for (int i = 0; i < jobs.size(); ++i) {
-      std::fill(average_policy.begin(), average_policy.end(), 0);
-      std::fill(average_value.begin(), average_value.end(), 0);
-
-      for (int type : batch_transformations[i]) {
-        const auto policy_ptr_end = policy_ptr_begin + policy_size;
-        const auto value_ptr_end = value_ptr_begin + value_size;
-
-        std::vector<float> policy(policy_ptr_begin, policy_ptr_end);
-        std::vector<float> restored_policy = game->restore_policy(policy, type);
-
-        // sum all policies and values
-        std::transform(restored_policy.begin(), restored_policy.end(),
-                       average_policy.begin(), average_policy.begin(),
-                       std::plus<float>());
-        std::transform(value_ptr_begin, value_ptr_end, average_value.begin(),
-                       average_value.begin(), std::plus<float>());
-
-        policy_ptr_begin = std::move(policy_ptr_end);
-        value_ptr_begin = std::move(value_ptr_end);
-      }
+  }
+  batch.model = gpu_job_toggle;
+  gpu_job_toggle = (gpu_job_toggle + 1) % num_models;
 
-      for (auto& p : average_policy) p /= Engine::batch_per_job;
-      for (auto& v : average_value) v /= Engine::batch_per_job;
-      jobs[i]->leaf_policy.assign(average_policy.begin(), average_policy.end());
-      jobs[i]->leaf_returns.assign(average_value.begin(), average_value.end());
-      jobs[i]->next_step = Job::Step::UPDATE;
+  assemble_batch(batch, rng);
+  PhaseHistograms::record(PhaseHistograms::kBatchAssemblyNs,
+                          std::chrono::steady_clock::now() - assembly_start);
+  return true;
+}
+
+template <class StateT>
+void BasicEngine<StateT>::assemble_batch(Batch& batch, std::mt19937& rng) {
+  const auto& jobs = batch.jobs;
+  // calculate input shape & size
+  const auto& observation_tensor_shape = game->observation_tensor_shape();
+  batch.input_shape.assign(observation_tensor_shape.begin(),
+                           observation_tensor_shape.end());
+  // add batch dimension (CHW -> BCHW)
+  batch.input_shape.insert(batch.input_shape.begin(),
+                           jobs.size() * Engine::batch_per_job);
+  const int input_size =
+      std::accumulate(batch.input_shape.begin(), batch.input_shape.end(), 1,
+                      std::multiplies<>());
+
+  auto& input_vector = batch.input;
+  input_vector.clear();
+  input_vector.reserve(input_size);
+  batch.transformations.clear();
+  batch.transformations.reserve(jobs.size());
+
+  // construct input tensor, record sampled transformations for each job
+  for (int i = 0; i < jobs.size(); ++i) {
+    std::vector<int> sampled_transformations;
+    if (Engine::num_sampled_transformations == 0) {
+      sampled_transformations.push_back(0);
+    } else {
+      std::sample(transformations.begin(), transformations.end(),
+                  std::back_inserter(sampled_transformations),
+                  Engine::num_sampled_transformations, rng);
+    }
+    batch.transformations.push_back(sampled_transformations);
+
+    const auto& observation = jobs[i]->leaf_observation;
+    for (int type : sampled_transformations) {
+      const auto offset = input_vector.size();
+      input_vector.insert(input_vector.end(), observation.begin(),
+                          observation.end());
+      game->transform_observations(input_vector.data() + offset, 1, type);
     }
+  }
+}
 
-    cpu_jobs.enqueue_bulk(std::make_move_iterator(jobs.begin()), jobs.size());
-    gpu_job_toggle = (gpu_job_toggle + 1) % num_models;
+template <class StateT>
+void BasicEngine<StateT>::forward_batch(Batch& batch) {
+  Tracer::Scope scope("forward");
+  PhaseHistograms::Timer timer(PhaseHistograms::kForwardNs);
+  EngineStats::add(EngineStats::kBatches);
+  EngineStats::add(EngineStats::kBatchedJobs, batch.jobs.size());
+
+  if (Engine::stub_inference) {
+    // uniform policy (normalised over legal actions in update) & zero value
+    const int64_t rows = batch.input_shape[0];
+    const auto forward_start = std::chrono::steady_clock::now();
+    batch.policy = torch::ones({rows, game->num_distinct_actions()});
+    batch.value = torch::zeros({rows, game->num_players()});
+    if (Engine::stub_latency_us > 0) {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(Engine::stub_latency_us));
+    }
+    batch_controller.record_forward(
+        batch.jobs.size(), std::chrono::steady_clock::now() - forward_start);
+    return;
   }
+
+  if (Engine::native_inference) {
+    // the native backend writes straight into the output tensors
+    const auto model_ptr = model_manager.get_native(batch.model);
+    const int64_t rows = batch.input_shape[0];
+    const auto forward_start = std::chrono::steady_clock::now();
+    batch.policy = torch::empty({rows, model_ptr->policy_size()});
+    batch.value = torch::empty({rows, model_ptr->value_size()});
+    model_ptr->forward(batch.input.data(), rows,
+                       batch.policy.template data_ptr<float>(),
+                       batch.value.template data_ptr<float>());
+    batch_controller.record_forward(
+        batch.jobs.size(), std::chrono::steady_clock::now() - forward_start);
+    return;
+  }
+
+  auto [device, model_ptr] = model_manager.get(batch.model);
+  auto input_tensor =
+      torch::from_blob(batch.input.data(), batch.input_shape).to(device);
+
+  // inference
+  const auto forward_start = std::chrono::steady_clock::now();
+  const auto results =
+      model_ptr->forward({input_tensor}).toTuple()->elements();
+  batch.policy = results[0].toTensor().cpu().contiguous();
+  batch.value = results[1].toTensor().cpu().contiguous();
+  batch_controller.record_forward(
+      batch.jobs.size(), std::chrono::steady_clock::now() - forward_start);
 }
 
+template <class StateT>
+void BasicEngine<StateT>::scatter_batch(Batch& batch) {
+  Tracer::Scope scope("scatter");
+  auto& jobs = batch.jobs;
+  const auto policy_size = batch.policy[0].numel();
+  const auto value_size = batch.value[0].numel();
+
+  auto policy_ptr_begin = batch.policy.template data_ptr<float>();
+  auto value_ptr_begin = batch.value.template data_ptr<float>();
+
+  std::vector<float> average_policy(policy_size);
+  std::vector<float> average_value(value_size);
+  // copy results back to jobs
+  for (int i = 0; i < jobs.size(); ++i) {
+    std::fill(average_policy.begin(), average_policy.end(), 0);
+    std::fill(average_value.begin(), average_value.end(), 0);
+
+    for (int type : batch.transformations[i]) {
+      const auto policy_ptr_end = policy_ptr_begin + policy_size;
+      const auto value_ptr_end = value_ptr_begin + value_size;
+
+      // batch.policy is our own copy, restore it in place
+      game->restore_policies(policy_ptr_begin, 1, type);
+
+      // sum all policies and values
+      std::transform(policy_ptr_begin, policy_ptr_end,
+                     average_policy.begin(), average_policy.begin(),
+                     std::plus<float>());
+      std::transform(value_ptr_begin, value_ptr_end, average_value.begin(),
+                     average_value.begin(), std::plus<float>());
+
+      policy_ptr_begin = std::move(policy_ptr_end);
+      value_ptr_begin = std::move(value_ptr_end);
+    }
+
+    for (auto& p : average_policy) p /= Engine::batch_per_job;
+    for (auto& v : average_value) v /= Engine::batch_per_job;
+    jobs[i]->leaf_policy.assign(average_policy.begin(), average_policy.end());
+    jobs[i]->leaf_returns.assign(average_value.begin(), average_value.end());
+    jobs[i]->next_step = Job::Step::UPDATE;
+    if (Tracer::recording()) {
+      Tracer::record_async("EVALUATE",
+                           reinterpret_cast<uintptr_t>(jobs[i].get()),
+                           jobs[i]->evaluate_begin, Tracer::Clock::now());
+    }
+  }
+
+  // deterministic_worker requeues them itself, in batch order
+  if (Engine::deterministic) return;
+
+  // back to the worker that selected them
+  for (auto& job : jobs) {
+    const int worker = job->worker;
+    cpu_jobs.enqueue(worker, std::move(job));
+  }
+  jobs.clear();
+}
+
+template class BasicEngine<game::State>;
+template class BasicEngine<game::slither::SlitherState>;
+
 }  // namespace clap::mcts::vl
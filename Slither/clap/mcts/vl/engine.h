@@ -1,37 +1,33 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "clap/game/game.h"
+#include "clap/mcts/batch_controller.h"
+#include "clap/mcts/engine_stats.h"
 #include "clap/mcts/model_manager.h"
+#include "clap/mcts/thread_placement.h"
+#include "clap/mcts/tracer.h"
 #include "clap/mcts/vl/job.h"
+#include "clap/mcts/work_scheduler.h"
 #include "third_party/concurrentqueue/blockingconcurrentqueue.h"
 
+namespace clap::game::slither {
+class SlitherState;
+}  // namespace clap::game::slither
+
 namespace clap::mcts::vl {
 
-class Engine {
+// Search parameters, shared by every instantiation of BasicEngine (and read
+// by Node and Tree).
+class EngineConfig {
  public:
-  Engine(const std::vector<int>& gpus, int models = 1);
-
-  void load_game(const std::string& name);
-  void load_model(const std::string& path, int version = 0);
-  void start(int cpu_workers, int gpu_workers, int num_envs = -1);
-  std::string get_trajectory();
-  void stop();
-
-  void add_job(int num = 1, const std::string& serialize_string = "");
-
-  void cpu_worker(uint32_t seed);
-  void gpu_worker(uint32_t seed);
-
-  ~Engine() = default;
-
-  bool running;
-
-  const std::vector<int> gpus;
-
   static int batch_size;
   static int max_simulations;
 
@@ -45,6 +41,41 @@ class Engine {
 
   static int temperature_drop;
   static int inference_wait_ms;
+  static bool adaptive_batching;
+  static bool pipelined_inference;
+  static bool optimize_model;
+  static bool warmup_model;
+  static bool native_inference;
+  // pin workers to these cores (index % size), overriding auto_affinity
+  static std::vector<int> cpu_worker_cores;
+  static std::vector<int> gpu_worker_cores;
+  static bool auto_affinity;
+  static bool numa_interleave;
+  // print EngineStats to stderr every interval, 0 to disable
+  static int stats_interval_ms;
+  // write a Chrome trace of the run to this file on stop(), empty to disable
+  static std::string trace_path;
+  // collect PhaseHistograms, see get_histograms()
+  static bool phase_histograms;
+  // evaluate without a model: uniform policy, zero value and a fixed fake
+  // forward latency, for benchmarks
+  static bool stub_inference;
+  static int stub_latency_us;
+  // search on a single thread in a fixed order, so equal inputs and seeds give
+  // equal trees and visit counts; cpu and gpu worker counts are ignored
+  static bool deterministic;
+  // seed of the worker rngs, 0 draws them from std::random_device unless
+  // deterministic
+  static uint32_t seed;
+  // label the leaves where white can not stop black by State::block_in_one,
+  // which searches every white turn and is exact, instead of the patterns of
+  // check_can_block, which misjudge some positions; the default keeps the
+  // old, inexact check_can_block labels
+  static bool tactical_oracle;
+  // results of check_can_block and block_in_one kept for all jobs, see
+  // Game::set_cache_entries, 0 disables the cache; the first engine to start
+  // with a nonzero size fixes it
+  static size_t cache_entries;
   static int virtual_loss;
 
   static bool play_until_terminal;
@@ -55,18 +86,95 @@ class Engine {
   static int top_n_childs;
   static bool states_value_using_childs;
   static bool dump_tree;
+};
+
+// Virtual-loss MCTS engine over states of type StateT, as
+// clap::mcts::BasicEngine. Instantiated in engine.cc.
+template <class StateT>
+class BasicEngine : public EngineConfig {
+ public:
+  using Engine = BasicEngine;
+  using Job = BasicJob<StateT>;
+
+  BasicEngine(const std::vector<int>& gpus, int models = 1);
+
+  void load_game(const std::string& name);
+  void load_model(const std::string& path, int version = 0);
+  void start(int cpu_workers, int gpu_workers, int num_envs = -1);
+  std::string get_trajectory();
+  void stop();
+
+  void add_job(int num = 1, const std::string& serialize_string = "");
+
+  void cpu_worker(int id, uint32_t seed);
+  void gpu_worker(uint32_t seed);
+  // runs every job and batch on one thread in a fixed order, see deterministic
+  void deterministic_worker(uint32_t seed);
+  // advances the job until it needs inference or leaves the search
+  void step_job(Job& job, std::mt19937& rng);
+
+  // pipelined inference: batch_worker -> inference_worker -> scatter_worker
+  void batch_worker(uint32_t seed);
+  void inference_worker();
+  void scatter_worker();
+
+  struct Batch {
+    int model;
+    std::vector<std::unique_ptr<Job>> jobs;
+    // sampled transformations of each job
+    std::vector<std::vector<int>> transformations;
+    std::vector<int64_t> input_shape;
+    std::vector<float> input;
+    torch::Tensor policy;
+    torch::Tensor value;
+  };
+  bool collect_batch(Batch& batch, std::mt19937& rng, int& gpu_job_toggle);
+  // fills the input of the collected jobs
+  void assemble_batch(Batch& batch, std::mt19937& rng);
+  void forward_batch(Batch& batch);
+  void scatter_batch(Batch& batch);
+
+  ~BasicEngine() = default;
+
+  bool running;
+
+  const std::vector<int> gpus;
 
   game::GamePtr game;
   ModelManager model_manager;
+  BatchController batch_controller;
+  ThreadPlacement thread_placement;
+  // counters of this engine's workers, see get_stats()
+  EngineStats stats;
+  // phase distributions of this engine's workers, see get_histograms()
+  PhaseHistograms histograms;
+  // trace of this engine's workers, written to Engine::trace_path on stop()
+  Tracer tracer;
+  StatsReporter stats_reporter;
   int num_models;
 
   std::vector<std::thread> cpu_threads;
   std::vector<std::thread> gpu_threads;
+  std::vector<std::thread> batch_threads;
+  std::vector<std::thread> scatter_threads;
 
-  moodycamel::BlockingConcurrentQueue<std::unique_ptr<Job>> cpu_jobs;
+  static constexpr auto kPipelinePollInterval = std::chrono::milliseconds(1);
+  // all transformation types of the game
+  std::vector<int> transformations;
+
+  WorkScheduler<std::unique_ptr<Job>> cpu_jobs;
+  // held while add_job queues a group of jobs
+  std::mutex add_job_mutex;
   std::vector<moodycamel::BlockingConcurrentQueue<std::unique_ptr<Job>>>
       gpu_jobs;
   moodycamel::BlockingConcurrentQueue<std::string> trajectories;
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<Batch>> free_batches;
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<Batch>> ready_batches;
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<Batch>> done_batches;
 };
 
+// Engine for any game, through the virtual game::State interface.
+using Engine = BasicEngine<game::State>;
+using SlitherEngine = BasicEngine<game::slither::SlitherState>;
+
 }  // namespace clap::mcts::vl
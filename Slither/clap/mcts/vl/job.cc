@@ -1,5 +1,7 @@
 #include "clap/mcts/vl/job.h"
 
+#include "clap/game/slither/slither.h"
+#include "clap/mcts/engine_stats.h"
 #include "clap/mcts/vl/engine.h"
 #include "clap/mcts/vl/node.h"
 #include "clap/mcts/vl/tree.h"
@@ -7,7 +9,9 @@
 
 namespace clap::mcts::vl {
 
-Job::Job(Engine* engine, const std::string& serialize_string)
+template <class StateT>
+BasicJob<StateT>::BasicJob(Engine* engine,
+                           const std::string& serialize_string)
     : engine(engine),
       next_step(Step::SELECT),
       tree_owner(true),
@@ -17,10 +21,11 @@ Job::Job(Engine* engine, const std::string& serialize_string)
   }
 }
 
-void Job::select(std::mt19937& rng) {
+template <class StateT>
+void BasicJob<StateT>::select(std::mt19937& rng) {
   // //std::cout<<"select start\n";
   auto leaf_node = tree.root_node.get();
-  leaf_state = root_state->clone();
+  leaf_state = root_state;
   
   game::Player previous_player = leaf_state->current_player();
   selection_path.clear();
@@ -35,17 +40,13 @@ void Job::select(std::mt19937& rng) {
     if((previous_player != leaf_state->current_player()) && tree.lookup_TT(leaf_node->boardInt)) {
       if (leaf_node == tree.root_node.get()) {
         // leaf_node->expand_done();
-        std::cout << "root in TT\n";
         if(tree_owner) {
-          std::cout << "owner\n";
           next_step = Step::PLAY;
         }else {
-          std::cout << "not owner\n";
           next_step = Step::DONE;
         }
         break;
       }
-      std::cout<< "Found in TT (select)"<< std::endl;
       leaf_node->label = 0;
       leaf_node->isTT = true;
       leaf_policy.clear();
@@ -69,25 +70,27 @@ void Job::select(std::mt19937& rng) {
         next_step = Step::EVALUATE;
         break;
       }
+      if (Engine::deterministic &&
+          leaf_node->expand_state.load() == Node::State::EXPANDING) {
+        // retried once the expanding job is updated, without its visits
+        for (auto& [parent_player, current_player, node, act] : selection_path)
+          node->num_visits -= Engine::virtual_loss;
+        next_step = Step::BLOCKED;
+        break;
+      }
     }
-    auto tmp = leaf_node;
     // std::tie(action, leaf_node) = leaf_node->select(rng);
     std::tie(action, leaf_node) = leaf_node->select(rng);
     if (action == -1) {
         // std::cout<<"action == -1\n";
-        if(tmp == tree.root_node.get()) {
-          std::cout<<"root: "<<tmp->label<<'\n';
-        }
         leaf_policy.clear();
         leaf_returns = leaf_state->returns();
         if(tree_owner) {
           next_step = Step::PLAY;
-          std::cout << "owner\n";
         }else {
           // leaf_node->expand_done();
           // std::cout<<tree.root_node.use_count()<<'\n';
           next_step = Step::DONE;
-          std::cout << "not owner\n";
         }
         break;
     }
@@ -104,7 +107,8 @@ void Job::select(std::mt19937& rng) {
   
 }
 
-void Job::evaluate() {
+template <class StateT>
+void BasicJob<StateT>::evaluate() {
   // std::cout << "evaluate\n";
   // std::cout<<"job.cc line: 76\n";
   const auto& observation_tensor_shape =
@@ -130,8 +134,8 @@ void Job::evaluate() {
 
   // inference
   auto results = model_ptr->forward({input_tensor}).toTuple()->elements();
-  auto batch_policy = results[0].toTensor().cpu();
-  auto batch_value = results[1].toTensor().cpu();
+  torch::Tensor batch_policy = results[0].toTensor().cpu();
+  torch::Tensor batch_value = results[1].toTensor().cpu();
 
   const auto& policy_ptr = batch_policy[0].data_ptr<float>();
   const auto& policy_size = batch_policy[0].numel();
@@ -140,10 +144,11 @@ void Job::evaluate() {
   const auto& value_ptr = batch_value[0].data_ptr<float>();
   const auto& value_size = batch_value[0].numel();
   leaf_returns.assign(value_ptr, value_ptr + value_size);
-  next_step = Job::Step::UPDATE;
+  next_step = Step::UPDATE;
 }
 
-void Job::update(std::mt19937& rng) {
+template <class StateT>
+void BasicJob<StateT>::update(std::mt19937& rng) {
 
   for (auto& [parent_player, current_player, node, act] : selection_path) {
     node->num_visits -= Engine::virtual_loss - 1;
@@ -151,10 +156,17 @@ void Job::update(std::mt19937& rng) {
     atomic_add(node->current_player_value_sum, leaf_returns[current_player]);
   }
   auto& [parent_player, current_player, leaf_node, act] = selection_path.back();
+  const int leaf_label = leaf_node->label;
 
   if((parent_player == 0) && (current_player == 1)) {
   //  std::cout<< "before check can block\n";
-   if(!leaf_state->check_can_block()) {
+   bool can_block;
+   {
+     PhaseHistograms::Timer timer(PhaseHistograms::kCheckCanBlockNs);
+     can_block = Engine::tactical_oracle ? leaf_state->block_in_one()
+                                         : leaf_state->check_can_block();
+   }
+   if(!can_block) {
       // std::cout<< "after check can block\n";
       
      leaf_node->label = 0; // black win
@@ -164,7 +176,7 @@ void Job::update(std::mt19937& rng) {
   if (!leaf_policy.empty() && leaf_node->label == 2) {
     // auto& [parent_player, current_player, leaf_node, act] = selection_path.back();
     const auto legal_actions = leaf_state->legal_actions();
-    leaf_node->expand(tree, leaf_state.get(), legal_actions);
+    leaf_node->expand(tree, &*leaf_state, legal_actions);
     // extract legal action policy and normalize
     float policy_sum = 0.0F;
     for (auto& [p, action, child] : leaf_node->children) {
@@ -227,10 +239,13 @@ void Job::update(std::mt19937& rng) {
   }
 
   auto pre_label = leaf_node->label;
+  if (leaf_label == 2 && pre_label != 2)
+    EngineStats::add(EngineStats::kLabelsResolved);
   int i = selection_path.size() - 2;
 
   while((i >= 0) && (pre_label != 2)) {
     auto& [p_player, c_player, node, a] = selection_path[i];
+    const int node_label = node->label;
 
     if((pre_label == 0) && (p_player == 0) && (c_player == 0)){ // black choose, black move
       node->label = pre_label;
@@ -276,6 +291,8 @@ void Job::update(std::mt19937& rng) {
     //   std::cout << leaf_state->printBoard({}, {}) << '\n';
     // }
     pre_label = node->label;
+    if (node_label == 2 && pre_label != 2)
+      EngineStats::add(EngineStats::kLabelsResolved);
     i--;
   }
   leaf_node->expand_done();
@@ -300,8 +317,8 @@ void Job::update(std::mt19937& rng) {
     // }
 
     next_step = Step::SELECT;
-    // if(tree.root_node->num_visits % 50000 == 0) 
-    std::cout<< tree.root_node->num_visits << '\n';
+    // progress is printed by the stats reporter (Engine::stats_interval_ms)
+    EngineStats::add(EngineStats::kSimulations);
     if (tree.root_node->num_visits > 15000000) {
       next_step = Step::DONE;
     }
@@ -309,7 +326,8 @@ void Job::update(std::mt19937& rng) {
 
 }
 
-void Job::play(std::mt19937& rng) {
+template <class StateT>
+void BasicJob<StateT>::play(std::mt19937& rng) {
   // std::cerr<<"test"<<std::endl;
   while (tree.root_node.use_count() != 1) {
     // std::cout<<"use_count: "<<tree.root_node.use_count()<<'\n';
@@ -434,7 +452,8 @@ void Job::play(std::mt19937& rng) {
   }
 }
 
-void Job::report() {
+template <class StateT>
+void BasicJob<StateT>::report() {
   std::string raw;
   trajectory.SerializeToString(&raw);
   engine->trajectories.enqueue(std::move(raw));
@@ -450,4 +469,7 @@ void Job::report() {
   }
 }
 
-}  // namespace clap::mcts::vl
\ No newline at end of file
+template class BasicJob<game::State>;
+template class BasicJob<game::slither::SlitherState>;
+
+}  // namespace clap::mcts::vl
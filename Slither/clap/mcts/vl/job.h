@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <random>
 #include <tuple>
 #include <vector>
@@ -7,6 +8,7 @@
 
 
 #include "clap/game/game.h"
+#include "clap/mcts/state_holder.h"
 #include "clap/mcts/vl/tree.h"
 #include "clap/pb/clap.pb.h"
 
@@ -15,20 +17,25 @@ namespace clap::mcts::vl {
 
 
 class Node;
-class Engine;
+template <class StateT>
+class BasicEngine;
 
-class Job {
+template <class StateT>
+class BasicJob {
  public:
-  enum Step { SELECT, EVALUATE, UPDATE, PLAY, REPORT, DONE };
+  using Engine = BasicEngine<StateT>;
+  // BLOCKED: select reached a node another job is expanding, only returned in
+  // Engine::deterministic mode where waiting for it would never end
+  enum Step { SELECT, EVALUATE, UPDATE, PLAY, REPORT, DONE, BLOCKED };
 
-  Job(Engine* engine, const std::string& serialize_string = "");
+  BasicJob(Engine* engine, const std::string& serialize_string = "");
   void select(std::mt19937& rng);
   void evaluate();
   void update(std::mt19937& rng);
   void play(std::mt19937& rng);
   void report();
   void PreOrderTraversalDump(std::ofstream& sgf_file_, const Node& current_node,
-                             const game::StatePtr& current_state,
+                             game::State& current_state,
                              const float& prior, const int& parent_num_visits,
                              const game::Action& last_action) const;
   void print_mcts_results(const int top_n) const;
@@ -36,9 +43,13 @@ class Job {
 
   Engine* engine;
   Step next_step;
+  // cpu worker that selected this job, -1 if it never left one
+  int worker = -1;
+  // when the job was queued for inference
+  std::chrono::steady_clock::time_point evaluate_begin;
 
   // select
-  game::StatePtr leaf_state;
+  StateHolder<StateT> leaf_state;
   std::vector<float> leaf_observation;
   // previous player, current player, node ptr
   std::vector<std::tuple<game::Player, game::Player, Node*, game::Action>> selection_path;
@@ -49,7 +60,7 @@ class Job {
   Tree tree;
   bool tree_owner;
   // play
-  game::StatePtr root_state;
+  StateHolder<StateT> root_state;
   // report
   clap::pb::Trajectory trajectory;
 };
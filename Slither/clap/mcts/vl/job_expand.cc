@@ -2,9 +2,11 @@
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
 #include "clap/game/game.h"
+#include "clap/game/slither/slither.h"
 #include "clap/mcts/vl/engine.h"
 #include "clap/mcts/vl/job.h"
 #include "clap/mcts/vl/node.h"
@@ -12,7 +14,8 @@
 
 namespace clap::mcts::vl {
 
-void Job::print_mcts_results(const int top_n) const {
+template <class StateT>
+void BasicJob<StateT>::print_mcts_results(const int top_n) const {
   std::vector<int> children_index;
   const auto& children = tree.root_node->children;
   for (int i = 0; i < children.size(); i++) {
@@ -45,7 +48,8 @@ void Job::print_mcts_results(const int top_n) const {
   }
 }
 
-void Job::dump_mcts() const {
+template <class StateT>
+void BasicJob<StateT>::dump_mcts() const {
   const game::GamePtr& game = engine->game;
   std::ofstream sgf_file_;
   std::time_t now = std::time(0);
@@ -59,7 +63,9 @@ void Job::dump_mcts() const {
   sgf_file_.open(folder + "MCTS_" + dt.str() + ".sgf");
   //  sgf_file_.open("MCTS_" + dt.str() + ".sgf");
   sgf_file_ << "(";
-  PreOrderTraversalDump(sgf_file_, *tree.root_node.get(), root_state, 1.0,
+  // the dump plays the moves on this copy and takes them back
+  StateHolder<StateT> state = root_state;
+  PreOrderTraversalDump(sgf_file_, *tree.root_node.get(), *state, 1.0,
                         (tree.root_node.get())->num_visits, 0);
   sgf_file_.close();
   system(("./parser " + filename).c_str());
@@ -70,27 +76,27 @@ void Job::dump_mcts() const {
 }
 
 const std::vector<std::string> color{"B", "W", "UNKNOWN"};
-void Job::PreOrderTraversalDump(std::ofstream& sgf_file_,
-                                const Node& current_node,
-                                const game::StatePtr& parent_state,
-                                const float& prior,
-                                const int& parent_num_visits,
-                                const game::Action& last_action) const {
-  game::StatePtr current_state = parent_state->clone();
+template <class StateT>
+void BasicJob<StateT>::PreOrderTraversalDump(
+    std::ofstream& sgf_file_, const Node& current_node,
+    game::State& parent_state, const float& prior,
+    const int& parent_num_visits, const game::Action& last_action) const {
+  // the child position, made in place when the game supports undo
+  std::optional<game::ScopedAction> move;
   // sgf_file_ << "(;";
   Node* test = tree.root_node.get();
   if (&current_node == test) {
     sgf_file_ << ";GM[CLAP]";
     // GM[CLAP]
-    // sgf_file_ << parent_state->serialize();
-    sgf_file_ << parent_state->serialize_num_to_char();
+    // sgf_file_ << parent_state.serialize();
+    sgf_file_ << parent_state.serialize_num_to_char();
     // sgf_file_ << "\r\nC[Label: " << label_char[current_node.label] <<
     // "\r\n]";
     //     ;B[KJ];W[KI];W[LJ];B[MK];B[ML];W[LK];W[LI];B[MI];B[MJ];W[MH];W[NH];B[MM];B[MN]
   } else {
     // if
 
-    sgf_file_ << ";" << color[parent_state->current_player()] << "["
+    sgf_file_ << ";" << color[parent_state.current_player()] << "["
               << engine->game->action_to_string(last_action) << "]";
     // sgf_file_ << "\r\nC[Simulation Count: " << current_node.num_visits <<
     // "\r\n"; sgf_file_ << "MCTS Value: "
@@ -108,8 +114,9 @@ void Job::PreOrderTraversalDump(std::ofstream& sgf_file_,
     }
     sgf_file_ << "\r\n]";
 
-    current_state->apply_action(last_action);
+    move.emplace(parent_state, last_action);
   }
+  game::State& current_state = move ? move->state() : parent_state;
   int n_child = 0;
   for (auto& child : current_node.children) {
     if (std::get<2>(child)->num_visits != 0) {
@@ -133,4 +140,10 @@ void Job::PreOrderTraversalDump(std::ofstream& sgf_file_,
   }
 }
 
+template void BasicJob<game::State>::print_mcts_results(const int) const;
+template void BasicJob<game::State>::dump_mcts() const;
+template void BasicJob<game::slither::SlitherState>::print_mcts_results(
+    const int) const;
+template void BasicJob<game::slither::SlitherState>::dump_mcts() const;
+
 }  // namespace clap::mcts::vl
@@ -4,6 +4,8 @@
 #include <cmath>
 #include <iostream>
 
+#include "clap/mcts/engine_stats.h"
+#include "clap/mcts/tracer.h"
 #include "clap/mcts/vl/engine.h"
 #include "clap/mcts/vl/tree.h"
 
@@ -61,6 +63,7 @@ std::tuple<game::Action, Node*> Node::select(std::mt19937& rng) const {
 
 void Node::expand(Tree& tree, game::State* state, const std::vector<game::Action>& legal_actions) {
   // std::cout<< "node expand"<< std::endl;
+  EngineStats::add(EngineStats::kExpansions);
   children.reserve(legal_actions.size());
   for (const auto& action : legal_actions) {
     auto cur_state = state;
@@ -68,7 +71,6 @@ void Node::expand(Tree& tree, game::State* state, const std::vector<game::Action
     cur_state->apply_action(action);
     node->boardInt = cur_state->convert_to_uint64_t(cur_state->getboard());
     if(tree.lookup_TT(node->boardInt)) {
-      std::cout<< "Found in TT (expand)"<< std::endl;
       node->label = 0;
       node->isTT = true;
     }else{
@@ -82,6 +84,9 @@ void Node::expand(Tree& tree, game::State* state, const std::vector<game::Action
 }
 
 void Node::wait_expand() const {
+  if (expand_state.load() != State::EXPANDING) return;
+  Tracer::Scope scope("wait_expand");
+  PhaseHistograms::Timer timer(PhaseHistograms::kWaitExpandNs);
   while (expand_state.load() == State::EXPANDING) {
   }
 }
@@ -1,5 +1,6 @@
 #include "clap/mcts/vl/tree.h"
 
+#include "clap/mcts/engine_stats.h"
 #include "clap/mcts/vl/engine.h"
 #include "clap/mcts/vl/node.h"
 
@@ -41,9 +42,11 @@ void Tree::store_TT(uint64_t board, int label){
 }
 
 bool Tree::lookup_TT(uint64_t board){
+    EngineStats::add(EngineStats::kTTProbes);
     std::lock_guard<std::mutex> guard(TTmutex);
     auto it = TT.find(board);
     if (it != TT.end()) {
+        EngineStats::add(EngineStats::kTTHits);
         return true;
     } else {
         return false;
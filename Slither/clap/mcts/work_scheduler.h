@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "third_party/concurrentqueue/concurrentqueue.h"
+#include "third_party/concurrentqueue/lightweightsemaphore.h"
+
+namespace clap::mcts {
+
+// Work-stealing queue of the cpu workers.
+// Every worker owns a deque and pops the most recently pushed item from its
+// back, so a job returning from inference resumes on the worker that selected
+// it while the selection path is still in cache. Items without a home go to a
+// shared injection queue. An idle worker takes from the front of its
+// neighbours' deques, nearest worker id first.
+template <class T>
+class WorkScheduler {
+ public:
+  struct Stats {
+    uint64_t local;
+    uint64_t injected;
+    uint64_t stolen;
+  };
+
+  WorkScheduler() = default;
+
+  // must not race with the workers; items left from a previous run are kept
+  void reset(int num_workers) {
+    for (int i = 0; i < num_locals; ++i) {
+      for (auto& item : locals[i].items) injected.enqueue(std::move(item));
+      locals[i].items.clear();
+    }
+    num_locals = num_workers;
+    locals = std::make_unique<Local[]>(num_workers);
+  }
+
+  // shared injection queue
+  void enqueue(T item) {
+    injected.enqueue(std::move(item));
+    available.signal();
+  }
+
+  // back of the worker's own deque, falls back to the injection queue
+  void enqueue(int worker, T item) {
+    if (worker < 0 || worker >= num_locals) return enqueue(std::move(item));
+    auto& local = locals[worker];
+    {
+      std::lock_guard lock(local.mutex);
+      local.items.push_back(std::move(item));
+    }
+    available.signal();
+  }
+
+  void wait_dequeue(int worker, T& item) {
+    // a token guarantees an item somewhere, keep looking until it is found
+    while (!available.wait()) continue;
+    while (!try_dequeue(worker, item)) continue;
+  }
+
+  // wait_dequeue that gives up when nothing is queued
+  bool try_wait_dequeue(int worker, T& item) {
+    if (!available.tryWait()) return false;
+    while (!try_dequeue(worker, item)) continue;
+    return true;
+  }
+
+  Stats stats() const {
+    return {local_count.load(std::memory_order_relaxed),
+            injected_count.load(std::memory_order_relaxed),
+            stolen_count.load(std::memory_order_relaxed)};
+  }
+
+  ~WorkScheduler() = default;
+
+ private:
+  struct alignas(64) Local {
+    std::mutex mutex;
+    std::deque<T> items;
+  };
+
+  bool try_dequeue(int worker, T& item) {
+    if (worker >= 0 && worker < num_locals && pop_back(locals[worker], item)) {
+      local_count.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    if (injected.try_dequeue(item)) {
+      injected_count.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    for (int d = 1; d < num_locals; ++d) {
+      if (pop_front(locals[(worker + d) % num_locals], item)) {
+        stolen_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool pop_back(Local& local, T& item) {
+    std::lock_guard lock(local.mutex);
+    if (local.items.empty()) return false;
+    item = std::move(local.items.back());
+    local.items.pop_back();
+    return true;
+  }
+
+  static bool pop_front(Local& local, T& item) {
+    std::unique_lock lock(local.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || local.items.empty()) return false;
+    item = std::move(local.items.front());
+    local.items.pop_front();
+    return true;
+  }
+
+  int num_locals = 0;
+  std::unique_ptr<Local[]> locals;
+  moodycamel::ConcurrentQueue<T> injected;
+  // one token per queued item
+  moodycamel::LightweightSemaphore available;
+
+  std::atomic<uint64_t> local_count{0};
+  std::atomic<uint64_t> injected_count{0};
+  std::atomic<uint64_t> stolen_count{0};
+};
+
+}  // namespace clap::mcts
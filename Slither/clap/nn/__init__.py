@@ -1,3 +1,5 @@
 from .alphazero import AlphaZero
+from .native import export_native
+from .quantization import quantize_dynamic
 
-__all__ = ['AlphaZero']
+__all__ = ['AlphaZero', 'export_native', 'quantize_dynamic']
@@ -0,0 +1,67 @@
+import struct
+
+import torch
+from torch import nn
+
+from .resnet import ResNet
+
+MAGIC = 0x4e4e4c43  # "CLNN"
+VERSION = 1
+
+
+def _fold(conv, bn):
+    """Fold an eval-mode BatchNorm2d into the preceding convolution."""
+    scale = bn.weight / torch.sqrt(bn.running_var + bn.eps)
+    weight = conv.weight * scale.view(-1, 1, 1, 1)
+    bias = (conv.bias - bn.running_mean) * scale + bn.bias
+    return weight, bias
+
+
+def _write(f, *tensors):
+    for tensor in tensors:
+        f.write(tensor.detach().float().contiguous().cpu().numpy().tobytes())
+
+
+def _write_conv3x3(f, conv, bn):
+    weight, bias = _fold(conv, bn)
+    # (out, in, kh, kw) -> (kh, kw, in, out)
+    _write(f, weight.permute(2, 3, 1, 0), bias)
+
+
+def _write_conv1x1(f, conv, bn):
+    weight, bias = _fold(conv, bn)
+    # (out, in, 1, 1) -> (out, in)
+    _write(f, weight.flatten(1), bias)
+
+
+def _write_linear(f, linear):
+    # (out, in) -> (in, out)
+    _write(f, linear.weight.t(), linear.bias)
+
+
+def export_native(model, path):
+    """Write an AlphaZero model with a ResNet backbone in the format read by
+    clap::mcts::NativeModel (batch norms folded, channels-last weights).
+    """
+    if not isinstance(model.backbone, ResNet):
+        raise ValueError('native inference only supports the ResNet backbone')
+
+    in_channels, height, width = model.observation_tensor_shape
+    backbone = model.backbone
+    channels = backbone.conv1[0].out_channels
+    num_actions = model.policy_head_end[0].out_features
+    num_players = model.value_head_end[2].out_features
+
+    with torch.no_grad(), open(path, 'wb') as f:
+        f.write(struct.pack('<II', MAGIC, VERSION))
+        f.write(struct.pack('<7i', in_channels, height, width, channels,
+                            len(backbone.convs), num_actions, num_players))
+        _write_conv3x3(f, backbone.conv1[0], backbone.conv1[1])
+        for block in backbone.convs:
+            _write_conv3x3(f, block.conv1, block.bn1)
+            _write_conv3x3(f, block.conv2, block.bn2)
+        _write_conv1x1(f, model.policy_head_front[0], model.policy_head_front[1])
+        _write_linear(f, model.policy_head_end[0])
+        _write_conv1x1(f, model.value_head_front[0], model.value_head_front[1])
+        _write_linear(f, model.value_head_end[0])
+        _write_linear(f, model.value_head_end[2])
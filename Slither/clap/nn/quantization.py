@@ -0,0 +1,15 @@
+import copy
+
+import torch
+from torch import nn
+
+
+def quantize_dynamic(model):
+    """Return a copy of `model` with dynamic int8 weights for CPU inference.
+
+    Dynamic quantization only covers nn.Linear, which hits the policy/value
+    heads and the SE blocks; convolutions stay in float and are left to
+    freezing (conv-bn folding) on the C++ side.
+    """
+    model = copy.deepcopy(model).cpu().eval()
+    return torch.quantization.quantize_dynamic(model, {nn.Linear}, dtype=torch.qint8)
@@ -42,7 +42,9 @@ class Actor:
 
         self.model_info = clap_pb2.ModelInfo(name='default', version=-1)
 
-        self.engine = clap.mcts.Engine(args.gpus)
+        # the slither engine holds its states by value and calls them directly
+        engine_type = clap.mcts.SlitherEngine if config['game'] == 'slither' else clap.mcts.Engine
+        self.engine = engine_type(args.gpus)
         self.engine.load_game(config['game'])
         self.engine.batch_size = args.batch_size
         self.engine.max_simulations = config['mcts']['max_simulations']
@@ -54,6 +56,14 @@ class Actor:
         self.engine.batch_per_job = 1 if self.engine.num_sampled_transformations == 0 \
                                     else self.engine.num_sampled_transformations
         self.engine.save_observation = config['mcts']['save_observation']
+        self.engine.adaptive_batching = config['mcts'].get('adaptive_batching', False)
+        self.engine.pipelined_inference = config['mcts'].get('pipelined_inference', False)
+        self.engine.optimize_model = config['mcts'].get('optimize_model', False)
+        self.engine.warmup_model = config['mcts'].get('warmup_model', False)
+        self.engine.auto_affinity = config['mcts'].get('auto_affinity', False)
+        self.engine.numa_interleave = config['mcts'].get('numa_interleave', False)
+        self.engine.deterministic = config['mcts'].get('deterministic', False)
+        self.engine.seed = config['mcts'].get('seed', 0)
 
     async def prepare(self, args):
         model_subscribe = clap_pb2.Heartbeat()
@@ -56,10 +56,11 @@ class ReplayBuffer(Dataset):
         # if use transformation, sample one transformation and apply to state and policy
         if self.use_transformation:
             transformation_type = random.randint(0, self.game.num_transformations - 1)
-            observation = self.game.transform_observation(self.data[index][0].flatten().numpy(), transformation_type)
-            observation_tensor = torch.tensor(observation).view(self.game.observation_tensor_shape)
-            policy = self.game.transform_policy(self.data[index][1].numpy(), transformation_type)
-            target_policy = torch.tensor(policy)
+            # transform copies in place through the numpy views
+            observation_tensor = self.data[index][0].clone()
+            self.game.transform_observations(observation_tensor.view(1, -1).numpy(), transformation_type)
+            target_policy = self.data[index][1].clone()
+            self.game.transform_policies(target_policy.view(1, -1).numpy(), transformation_type)
             return (observation_tensor, target_policy, self.data[index][2])
         return self.data[index]
 
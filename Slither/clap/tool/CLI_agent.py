@@ -18,7 +18,9 @@ from clap.pb import clap_pb2
 
 class CLI_agent:
     def __init__(self, args):
-        self.engine = clap.mcts.VLEngine(args.gpus)
+        # the slither engine holds its states by value and calls them directly
+        engine_type = clap.mcts.SlitherVLEngine if args.game == 'slither' else clap.mcts.VLEngine
+        self.engine = engine_type(args.gpus)
 
         self.engine.batch_size = args.batch_size
         self.engine.max_simulations = args.simulation_count
@@ -30,6 +32,23 @@ class CLI_agent:
         self.engine.virtual_loss = 3
         self.engine.num_sampled_transformations = args.transform
         self.engine.batch_per_job = 1 if self.engine.num_sampled_transformations == 0 else self.engine.num_sampled_transformations
+        self.engine.adaptive_batching = args.adaptive_batching
+        self.engine.pipelined_inference = args.pipelined_inference
+        self.engine.optimize_model = args.optimize_model
+        self.engine.warmup_model = args.warmup_model
+        # --model is then a file written by gen_jit_model.py --native
+        self.engine.native_inference = args.native_inference
+        self.engine.cpu_worker_cores = args.cpu_cores
+        self.engine.gpu_worker_cores = args.gpu_cores
+        self.engine.auto_affinity = args.auto_affinity
+        self.engine.numa_interleave = args.numa_interleave
+        self.engine.stats_interval_ms = args.stats_interval_ms
+        self.engine.trace_path = args.trace
+        self.engine.phase_histograms = args.histograms
+        self.engine.deterministic = args.deterministic
+        self.engine.seed = args.seed
+        self.engine.tactical_oracle = args.tactical_block_check
+        self.engine.cache_entries = args.cache_entries
 
         self.engine.play_until_terminal = False
         self.engine.auto_reset_job = False
@@ -71,8 +90,7 @@ class CLI_agent:
         print(file=file)
 
     def printBoard(self, board=[]):
-        path = self.state.match_WP()
-        CPs = self.state.get_critical(path)
+        CPs = self.state.critical_points()
         print(CPs)
         print("=")
         print(self.state.printBoard(board, CPs))
@@ -312,89 +330,35 @@ class CLI_agent:
         print("done")
 
         
-    def test_prune(self):
-        posInt2Char=lambda p: chr(int(p)-1+ord('A'))
-
+    def checkmate_boards(self, stones):
+        # black stone masks, the mapped checkmate_N.bin that slither_boards
+        # writes when there is one
+        path = f'./checkmate/checkmate_{stones}'
+        if os.path.exists(path + '.bin'):
+            return clap.game.BoardFile(path + '.bin').masks
+        return clap.game.BoardFile.read_text(path + '.txt')
 
+    def test_prune(self):
         for i in range(4, 7):
             output = open(f"./test_prune/result_{i}.txt", "w")
-            file = open('./checkmate/'+'checkmate_'+str(i)+'.txt')
-            lines = file.readlines()
-            cnt = 1
             white_noBlock = 0
             white_all = 0
 
             print(i)
 
-            # output.write("(;GM[511]")
-
-            for line in lines:
-                # if cnt >= 210:
-                #     break
-                self.clear()
-                self.history = []
-                for point in line.strip().split():
-                    self.play_manual('play_manual 0 X X '+self.game.action_to_string(int(point)))
-                
-                CPs = self.state.get_critical(self.state.match_WP())
-
-                # rlt = "("
-                board = self.state.getboard()
-                # for b in range(len(board)):
-                #     if board[b] == 0:   # BLACK
-                #         piece = self.game.action_to_string(b)
-                #         rlt += ";B"
-                #         rlt += f"[{piece[0]}{posInt2Char(piece[1])}]"
-
-                # rlt += ";C["
-                # for CP in CPs:
-                #     rlt += "{"
-                #     for c in range(len(CP)):
-                #         if c != 0:
-                #             rlt += " "
-                #         rlt += self.game.action_to_string(CP[c])
-                #     rlt += "} "
-                # rlt += "]"
-
-                # output.write(rlt)
-
-                black_num = board.count(0)
-                all_num = 0
-                all_num = self.state.DFS_noBlock(board, black_num, 0, black_num, CPs, all_num)
-                boards = self.state.get_noBlock()
-                # cnt = 0
-                for b in boards:
-                    # rlt = "("
-                    # for w in range(len(b)):
-                    #     if b[w] == 1:  # WHITE
-                    #         piece = self.game.action_to_string(w)
-                    #         rlt += ";W"
-                    #         rlt += f"[{piece[0]}{posInt2Char(piece[1])}]"
-                    # print(cnt)
-                    # cnt += 1
-                    if not self.state.test_board(b):
-                        # rlt += ";C[black not win]"
-                        print("black not win")
-                        print(self.state.printBoard(b, []))
-                        output.write(self.state.printBoard(b, []))
-                        break
-                    # else:
-                    #     rlt += ";C[black win]"
-                    # rlt += ")"
-                    # output.write(rlt)
-
-                # output.write(")")
-                print(f"{cnt}: {len(boards)} / {all_num} = {len(boards) / all_num}") 
-                cnt += 1
-                white_noBlock += len(boards)
-                white_all += all_num
-            
-            # output.write(")")
+            # every board at once, on all cores and without the GIL
+            stats = self.state.prune_analysis(self.checkmate_boards(i))
+            for cnt, stat in enumerate(stats, 1):
+                if stat.counterexample:
+                    print("black not win")
+                    print(self.state.printBoard(stat.counterexample, []))
+                    output.write(self.state.printBoard(stat.counterexample, []))
+                print(f"{cnt}: {stat.kept} / {stat.valid} = {stat.kept / stat.valid}") 
+                white_noBlock += stat.kept
+                white_all += stat.valid
 
-            # print(f"Saved as test_prune/{i}.sgf")
             print(f"Avg: {white_noBlock} / {white_all} = {white_noBlock / white_all}")
             output.write(f"{i}: {white_noBlock} / {white_all} = {white_noBlock / white_all}")
-            file.close()
             output.close()
 
     def test_white_blockable(self):
@@ -594,6 +558,16 @@ class CLI_agent:
 
         self.stop()
 
+
+def parse_cores(cores):
+    # '0-3,8' -> [0, 1, 2, 3, 8]
+    result = []
+    for part in filter(None, cores.split(',')):
+        first, _, last = part.partition('-')
+        result.extend(range(int(first), int(last or first) + 1))
+    return result
+
+
 if __name__ == '__main__':
     import faulthandler
     faulthandler.enable()
@@ -624,9 +598,36 @@ if __name__ == '__main__':
     
     parser.add_argument('-b', '--batch-size', default=os.cpu_count()//2, type=int)
     parser.add_argument('-transform', '--transform', default=0, type=int)
+    parser.add_argument('-adaptive', '--adaptive-batching', action='store_true')
+    parser.add_argument('-pipeline', '--pipelined-inference', action='store_true')
+    parser.add_argument('-optimize', '--optimize-model', action='store_true')
+    parser.add_argument('-warmup', '--warmup-model', action='store_true')
+    parser.add_argument('-native', '--native-inference', action='store_true')
+    parser.add_argument('--cpu-cores', default='', type=str, help='e.g. 0-15,32-47')
+    parser.add_argument('--gpu-cores', default='', type=str)
+    parser.add_argument('-affinity', '--auto-affinity', action='store_true')
+    parser.add_argument('-interleave', '--numa-interleave', action='store_true')
+    parser.add_argument('-stats', '--stats-interval-ms', default=0, type=int,
+                        help='print search stats to stderr every N ms')
+    parser.add_argument('--trace', default='', type=str,
+                        help='write a Chrome trace (chrome://tracing, Perfetto) on stop')
+    parser.add_argument('--histograms', action='store_true',
+                        help='collect per-phase latency histograms (engine.get_histograms())')
+    parser.add_argument('--deterministic', action='store_true',
+                        help='search on one thread in a fixed order, reproducible with --seed')
+    parser.add_argument('--seed', default=0, type=int,
+                        help='seed of the worker rngs, 0 for a random one')
+    parser.add_argument('--tactical-block-check', action='store_true',
+                        help='find unblockable black threats by block_in_one, which searches every '
+                             'white turn and is exact; without it the old, inexact check_can_block '
+                             'patterns label the leaves')
+    parser.add_argument('--cache-entries', default=1 << 20, type=int,
+                        help='blockability results shared by all jobs, 0 to disable')
 
     args = parser.parse_args()
     args.gpus = [int(gpu) for gpu in args.gpus.split(',')]
+    args.cpu_cores = parse_cores(args.cpu_cores)
+    args.gpu_cores = parse_cores(args.gpu_cores)
 
     if args.verbose:
         print("cpu workers =", args.cpu_workers, file=sys.stderr)
@@ -45,7 +45,9 @@ class Evaluator:
         self.summary_writer = SummaryWriter(log_dir=self.log_dir, purge_step=self.args.best_iteration)
 
         self.game = clap.game.load(config['game'])
-        self.engine = clap.mcts.Engine(self.args.gpus, self.game.num_players)
+        # the slither engine holds its states by value and calls them directly
+        engine_type = clap.mcts.SlitherEngine if config['game'] == 'slither' else clap.mcts.Engine
+        self.engine = engine_type(self.args.gpus, self.game.num_players)
 
         self.engine.load_game(config['game'])
 
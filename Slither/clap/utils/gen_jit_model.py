@@ -2,19 +2,49 @@
 import torch
 import torch.jit
 import argparse
+import yaml
 
 import clap.game
-from clap.nn import AlphaZero
+from clap.nn import AlphaZero, export_native, quantize_dynamic
 
 
 def main():
-    game = clap.game.load('tic_tac_toe')
-    model = AlphaZero(game, 32, 5)
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-c', '--config', required=True, type=str)
+    parser.add_argument('-ckpt', '--checkpoint', required=False, type=str,
+                        help='learner checkpoint, random weights if omitted')
+    parser.add_argument('-o', '--output', default='0.jit.pt', type=str)
+    parser.add_argument('-q', '--quantize', action='store_true',
+                        help='dynamic int8 quantization (CPU only)')
+    parser.add_argument('-f', '--freeze', action='store_true',
+                        help='freeze the scripted module before saving')
+    parser.add_argument('-n', '--native', action='store_true',
+                        help='export weights for the native C++ backend')
+    args = parser.parse_args()
+
+    with open(args.config) as f:
+        config = yaml.safe_load(f)
+
+    game = clap.game.load(config['game'])
+    model = AlphaZero(game, config['model'])
+    if args.checkpoint:
+        checkpoint = torch.load(args.checkpoint, map_location='cpu')
+        model.load_state_dict(checkpoint['model'])
     model.eval()
 
+    if args.native:
+        export_native(model, args.output)
+        return
+
+    if args.quantize:
+        model = quantize_dynamic(model)
+
     sample_input = torch.rand(1, *game.observation_tensor_shape)
-    traced_model = torch.jit.trace(model, sample_input)
-    traced_model.save('0.jit.pt')
+    with torch.no_grad():
+        traced_model = torch.jit.trace(model, sample_input)
+    if args.freeze:
+        traced_model = torch.jit.freeze(traced_model)
+    traced_model.save(args.output)
 
 
 if __name__ == '__main__':
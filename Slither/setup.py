@@ -39,6 +39,9 @@ class CMakeBuild(build_ext):
 
         cmake_args = ['-DCMAKE_LIBRARY_OUTPUT_DIRECTORY=' + extdir,
                       '-DPYTHON_EXECUTABLE=' + sys.executable]
+        # CLAP_NATIVE_ARCH=0 for a build that runs on other CPUs
+        if os.environ.get('CLAP_NATIVE_ARCH', '1') == '0':
+            cmake_args += ['-DENABLE_NATIVE_ARCH=OFF']
 
         cfg = 'Debug' if self.debug else 'Release'
         build_args = ['--config', cfg]